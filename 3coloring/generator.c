@@ -5,11 +5,22 @@
  *
  * @brief A generator program that creates 3-coloring solutions for a given graph.
  * 
- * @details This program will receive a graph in its synopsis, ./generator edge... whereas edge is denoted as 0-1 or 12-1.
- *          Further on, it will color this graph with a random permutation, check for color confilicts, and remove the edges that produce the conflict.
+ * @details This program will receive a graph in its synopsis, ./generator [-a] edge... whereas edge is denoted as 0-1 or 12-1.
+ *          Further on, it will color this graph with 64 random permutations at once (bit-sliced) and improve the best of them with a local search
+ *          (min-conflicts with random walk and a tabu list), removing the edges that produce a color confilict. Every improvement is written
+ *          to the supervisor; without an improvement for a while the search restarts. The best coloring of every run is
+ *          written when it restarts (if it was not written yet), so each run counts against the limit of the supervisor,
+ *          also on graphs that are not 3-colorable. A run that is left with only the self loops as conflicts restarts
+ *          at once, so such graphs keep counting against the limit too.
+ *          With -a the generator runs simulated annealing instead, as an island with its own start temperature (given by the order in which
+ *          the generators start), cooling down and reheating. All generators periodically publish their best coloring in a best-state area
+ *          of the shared memory; an annealing island reheats from it, when it is better than its own best. An island
+ *          whose reheats stop improving its best starts from random colorings again (it can still come back to the
+ *          kept best through the best-state area).
  *          This generator program is completely dependent on the supervisor program - meaning, it cannot be started until the supervisor has started.
  *          More generator instances can be executed at once, but with the same graph! Otherwise, it does not really make sense.
- *          It uses shared memory from the supervisor to write its solutions, and semaphores to ensure non-blocking and raceconditions.
+ *          It uses shared memory from the supervisor to write its solutions into a lock-free ring: a slot is reserved with an atomic ticket,
+ *          published with its sequence number, and a generator only sleeps (on a futex) while the ring is full.
  * **/
 
 #include <stdio.h>
@@ -17,33 +28,41 @@
 #include <unistd.h>
 #include <string.h>
 #include <time.h>
-#include <semaphore.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <stdint.h>
 #include <sys/mman.h>
 #include <sys/types.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
-// region: SEMAPHORES
-#define SEM_1 "/sem_1_12127678" // freespace
-#define SEM_2 "/sem_2_12127678" // usedspace
-#define SEM_3 "/sem_3_12127678" // writing privileges
+#include "shared.h"
 
-// region: SHARED_MEMORY
-#define MAX_DATA (100) // maximal buffer
-#define SHM_NAME "/shared_12127678" // shared memory name
-#define NUMBER_OF_SOLUTIONS (20) // maximal size of one solution
+// region: BIT_SLICING
+#define LANES (64) // colorings evaluated at once, one per bit of a uint64_t
+#define CONFLICT_BITS (5) // bit-planes of the conflict counters, counts up to 31 > NUMBER_OF_SOLUTIONS
+
+// region: LOCAL_SEARCH
+#define WALK_PERCENT (10) // probability of a random recoloring (random walk)
+#define TABU_TENURE (10) // a node may not take its old color back for 10 to 19 steps
+#define SEARCH_BATCH (1024) // steps between two checks of the shared state
+#define RESTART_STEPS (100000) // steps without improvement (+ 100 per node) before a restart
+
+// region: ANNEALING
+#define ANNEAL_HOTTEST (0.4) // probability that the hottest island accepts a move adding one conflict, when it (re)heats
+#define ANNEAL_SPREAD (0.75) // island i starts at ANNEAL_HOTTEST * ANNEAL_SPREAD^i
+#define ANNEAL_ISLANDS (5) // different start temperatures, further islands wrap around
+#define ANNEAL_COOLING (0.999) // the temperature is multiplied by this after every search batch
+#define ANNEAL_COLDEST (0.001) // below this the island reheats
+#define ANNEAL_STALE_REHEATS (1) // reheats in a row without a new best of the island before it starts from random colorings
+#define ANNEAL_DELTAS (16) // moves adding this many conflicts or more are never accepted
+#define EXCHANGE_BATCHES (64) // search batches between two writes to the best-state area
+#define EXCHANGE_TRIES (16) // reads of the best-state area before giving up while it is written
 
 // program name
 static char *progname;
-
-/**
- * @struct edge
- * @brief This structure represents an edge in a graph.
- */
-typedef struct{
-    int first;
-    int second;
-} edge;
+// state of nextRandom
+static uint64_t randomState;
 
 /**
  * @struct edgeArray
@@ -56,7 +75,7 @@ typedef struct{
 
 /**
  * @struct nodesArray
- * @brief This structure represents a color permutation for all nodes.
+ * @brief This structure represents the unique nodes of the graph, sorted; the index of a node is its dense id.
  */
 typedef struct{
     int* nodes;
@@ -64,33 +83,39 @@ typedef struct{
 } nodesArray;
 
 /**
- * @struct solutionEdgeArr
- * @brief This structure represents an array of edges to be written to the shared memory. edges array is limited.
+ * @struct graph
+ * @brief This structure represents the graph with dense node ids 0..nodeCount-1.
+ * @details The endpoints of edge i are pairs[2 * i] and pairs[2 * i + 1], in the order of the arguments.
+ *          The neighbours of node v are adjacency[offsets[v]] .. adjacency[offsets[v + 1] - 1] (CSR).
+ *          Self loops (always a conflict) are only counted in selfLoops, not in the CSR arrays.
  */
 typedef struct{
-    edge edges[NUMBER_OF_SOLUTIONS];
-    size_t size;
-} solutionEdgeArr;
+    uint32_t *pairs;
+    uint32_t *offsets;
+    uint32_t *adjacency;
+    size_t nodeCount;
+    size_t edgeCount;
+    size_t selfLoops;
+} graph;
 
 /**
- * @struct sharedMemory
- * @brief This structure represents the shared memory object. 
- * @details state is 1 initially. 0 will be set, when the limit is reached or the supervisor found a solution.
- *          currentReading is the current reading element by the supervisor.
- *          currentWriting is the current writing element by the generator.
- *          numberOfGenerators is the number of currently running generators.
- *          limit is the limit set by the supervisor, maximal number of solutions to be written.
- *          edgeArray is the solutions array.
+ * @struct searchState
+ * @brief This structure represents the state of the local search.
+ * @details colors is the current coloring, counts[3 * v + c] the number of neighbours of v with color c, so v is in
+ *          conflict if counts[3 * v + colors[v]] > 0. conflicted lists these nodes, position[v] is the index of v in it
+ *          (-1 if v has no conflict). tabu[3 * v + c] is the step until v may not take color c back.
+ *          conflicts is the number of conflict edges (including self loops), step the number of steps made.
  */
 typedef struct{
-    int state;
-    int currentReading;
-    int currentWriting;
-    int numberOfGenerators;
-    int bestSolution;
-    int limit;
-    solutionEdgeArr edgeArray[MAX_DATA];
-} sharedMemory;
+    unsigned char *colors;
+    uint32_t *counts;
+    uint32_t *conflicted;
+    int32_t *position;
+    uint32_t conflictedCount;
+    uint64_t *tabu;
+    size_t conflicts;
+    uint64_t step;
+} searchState;
 
 /**
 * Usage function.
@@ -166,27 +191,24 @@ static edgeArray handleArguments(int argc, char **argv){
 }
 
 /**
-* Is Number in Array.
-* @brief This function checks if a number present in the parsed array.
+* compareNumbers function.
+* @brief qsort comparison of two ints.
 *
-* @param num number to be checked
-* @param array array
-* @param size array size
-* @return 1 on present, 0 on not present
+* @param a first int
+* @param b second int
+* @return negative, 0 or positive
 */
-static int isNumberInArray(int num, int *array, int size) {
-    for (int i = 0; i < size; ++i) {
-        if (array[i] == num) {
-            return 1;
-        }
-    }
-    return 0;
+static int compareNumbers(const void *a, const void *b){
+    int first = *(const int *) a;
+    int second = *(const int *) b;
+    return (first > second) - (first < second);
 }
 
 /**
 * Separate Nodes function.
-* @brief This function takes in an edgeArray and separates the nodes, returning them in nodesArray struct.
+* @brief This function takes in an edgeArray and separates the nodes, returning them sorted in nodesArray struct.
 * @details The cause of this function, is that edges can contain the same nodes, meaning there can be for example: "0-1" "0-2", where we have 2 edges, but 3 nodes.
+*          All endpoints are sorted and duplicates dropped, O(E log E). The index of a node in the result is its dense id.
 *
 * @param arr edgeArray containing all the edges
 * @return nodesArray on success, with the unique nodes; on failure memory will be freed and the program will terminate.
@@ -202,18 +224,16 @@ static nodesArray separateNodes(edgeArray arr){
         usage("memory allocation failed on creating nodes array");
     }
 
-    for(int i=0; i<arr.size * 2; i++){
-        result.nodes[i] = -1;
+    for(int i = 0; i < arr.size; i++){
+        result.nodes[2 * i] = arr.edges[i].first;
+        result.nodes[2 * i + 1] = arr.edges[i].second;
     }
-    
-    int count = 0;
+    qsort(result.nodes, arr.size * 2, sizeof(int), compareNumbers);
 
-    for (int i = 0; i < arr.size; i++) {
-        if (isNumberInArray(arr.edges[i].first, result.nodes, count) == 0) {
-            result.nodes[count++] = arr.edges[i].first;
-        }
-        if (isNumberInArray(arr.edges[i].second, result.nodes, count) == 0) {
-            result.nodes[count++] = arr.edges[i].second;
+    int count = 0;
+    for(int i = 0; i < arr.size * 2; i++){
+        if(count == 0 || result.nodes[count - 1] != result.nodes[i]){
+            result.nodes[count++] = result.nodes[i];
         }
     }
 
@@ -221,134 +241,723 @@ static nodesArray separateNodes(edgeArray arr){
       result.nodes = (int *) realloc(result.nodes, count * sizeof(int));
     }
 
-    // result.nodes = (int *) realloc(result.nodes, count * sizeof(int));
     result.size = count;
 
     return result;
 }
 
+/**
+* nodeId function.
+* @brief Returns the dense id of a node, its index in the sorted nodes array.
+*
+* @param node node as given on the command line
+* @param nodesArr sorted unique nodes
+* @return dense id
+*/
+static uint32_t nodeId(int node, nodesArray nodesArr){
+    size_t low = 0;
+    size_t high = nodesArr.size;
+    while(low < high){
+        size_t middle = low + (high - low) / 2;
+        if(nodesArr.nodes[middle] < node){
+            low = middle + 1;
+        }
+        else{
+            high = middle;
+        }
+    }
+    return (uint32_t) low;
+}
+
+/**
+* buildGraph function.
+* @brief This function preprocesses the edges once into the dense graph layout.
+* @details Every endpoint is replaced by its dense id (binary search), the pairs array holds them edge after edge.
+*          The CSR arrays are filled with a counting pass over the pairs.
+*
+* @param edgesArr edges array
+* @param nodesArr sorted unique nodes
+* @return graph (do not forget freeGraph!)
+*/
+static graph buildGraph(edgeArray edgesArr, nodesArray nodesArr){
+    graph result;
+    result.nodeCount = nodesArr.size;
+    result.edgeCount = edgesArr.size;
+    result.pairs = (uint32_t *) malloc(edgesArr.size * 2 * sizeof(uint32_t));
+    result.offsets = (uint32_t *) calloc(nodesArr.size + 1, sizeof(uint32_t));
+    result.adjacency = (uint32_t *) malloc(edgesArr.size * 2 * sizeof(uint32_t));
+
+    if(result.pairs == NULL || result.offsets == NULL || result.adjacency == NULL){
+        usage("memory allocation failed on creating the graph");
+    }
+
+    result.selfLoops = 0;
+    for(size_t i = 0; i < edgesArr.size; i++){
+        result.pairs[2 * i] = nodeId(edgesArr.edges[i].first, nodesArr);
+        result.pairs[2 * i + 1] = nodeId(edgesArr.edges[i].second, nodesArr);
+        if(result.pairs[2 * i] == result.pairs[2 * i + 1]){
+            result.selfLoops++;
+            continue;
+        }
+        result.offsets[result.pairs[2 * i] + 1]++;
+        result.offsets[result.pairs[2 * i + 1] + 1]++;
+    }
+    for(size_t v = 0; v < nodesArr.size; v++){
+        result.offsets[v + 1] += result.offsets[v];
+    }
+
+    uint32_t *next = (uint32_t *) malloc(nodesArr.size * sizeof(uint32_t));
+    if(next == NULL){
+        usage("memory allocation failed on creating the graph");
+    }
+    memcpy(next, result.offsets, nodesArr.size * sizeof(uint32_t));
+    for(size_t i = 0; i < edgesArr.size; i++){
+        uint32_t first = result.pairs[2 * i];
+        uint32_t second = result.pairs[2 * i + 1];
+        if(first == second){
+            continue;
+        }
+        result.adjacency[next[first]++] = second;
+        result.adjacency[next[second]++] = first;
+    }
+    free(next);
+
+    return result;
+}
+
+/**
+* freeGraph function.
+* @brief Frees the arrays of a graph.
+*
+* @param g graph
+*/
+static void freeGraph(graph g){
+    free(g.pairs);
+    free(g.offsets);
+    free(g.adjacency);
+}
+
+/**
+* graphHash function.
+* @brief Hashes a graph, so generators only exchange colorings of the same graph.
+* @details The sorted nodes (which give the dense ids) are hashed with FNV-1a, the edges are added up after mixing
+*          each of them, so the order of the arguments and of the endpoints does not matter.
+*
+* @param nodesArr sorted unique nodes
+* @param g graph with dense ids
+* @return hash of the graph
+*/
+static uint64_t graphHash(nodesArray nodesArr, graph g){
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    uint64_t edges = 0;
+
+    for(size_t i = 0; i < nodesArr.size; i++){
+        hash = (hash ^ (uint32_t) nodesArr.nodes[i]) * 0x100000001B3ULL;
+    }
+    for(size_t i = 0; i < g.edgeCount; i++){
+        uint64_t a = g.pairs[2 * i];
+        uint64_t b = g.pairs[2 * i + 1];
+        uint64_t x = (a < b ? a << 32 | b : b << 32 | a) * 0x9E3779B97F4A7C15ULL;
+        edges += x ^ (x >> 29);
+    }
+    return hash ^ edges;
+}
+
+/**
+* nextRandom function.
+* @brief xorshift64* generator, 64 random bits per call.
+*
+* @return random number
+*/
+static uint64_t nextRandom(void){
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    return randomState * 0x2545F4914F6CDD1DULL;
+}
+
 /**
 * ColorPermutation function.
-* @brief This function takes in an array and assings a random color to it.
-* @details 0 - Red, 1 - Blue, 2 - Green.
+* @brief This function assigns a random color to every node in each of the LANES colorings.
+* @details 0 - Red, 1 - Blue, 2 - Green. The colors are bit-sliced: bit l of low[v] and high[v] is the color of node v
+*          in coloring l. Lanes that drew the invalid color 3 are drawn again, so every color has probability 1/3.
+*
+* @param low low bit-plane of the colors
+* @param high high bit-plane of the colors
+* @param nodesSize number of nodes
+*/
+static void colorPermutation(uint64_t *low, uint64_t *high, size_t nodesSize){
+    for(size_t i = 0; i < nodesSize; i++){
+        uint64_t lowBits = nextRandom();
+        uint64_t highBits = nextRandom();
+        uint64_t invalid = lowBits & highBits;
+        while(invalid != 0){
+            lowBits = (lowBits & ~invalid) | (nextRandom() & invalid);
+            highBits = (highBits & ~invalid) | (nextRandom() & invalid);
+            invalid = lowBits & highBits;
+        }
+        low[i] = lowBits;
+        high[i] = highBits;
+    }
+}
+
+/**
+* sameColor function.
+* @brief Returns the lanes in which both endpoints of an edge have the same color.
+*
+* @param g graph with dense ids
+* @param low low bit-plane of the colors
+* @param high high bit-plane of the colors
+* @param i edge
+* @return conflict mask, bit l set if the edge is a conflict in coloring l
+*/
+static uint64_t sameColor(graph g, const uint64_t *low, const uint64_t *high, size_t i){
+    uint32_t first = g.pairs[2 * i];
+    uint32_t second = g.pairs[2 * i + 1];
+    return ~((low[first] ^ low[second]) | (high[first] ^ high[second]));
+}
+
+/**
+* sampleColorings function.
+* @brief This function takes in the graph. It creates LANES random colorings at once and returns the one with the
+*        fewest conflicts.
+* @details The conflicts of all lanes are counted together: the conflict mask of an edge is added to a bit-sliced
+*          counter of CONFLICT_BITS planes (a ripple-carry adder across the planes), lanes that overflow it are marked.
+*          Once every lane has overflowed, the remaining edges are skipped.
+*
+* @param g graph with dense ids
+* @param low low bit-plane buffer (nodeCount words), holds the colorings afterwards
+* @param high high bit-plane buffer (nodeCount words), holds the colorings afterwards
+* @return the lane with the fewest conflicts, 0 if every lane has more than NUMBER_OF_SOLUTIONS conflicts
+*/
+static int sampleColorings(graph g, uint64_t *low, uint64_t *high){
+
+    uint64_t counters[CONFLICT_BITS] = {0};
+    uint64_t overflow = 0;
+
+    colorPermutation(low, high, g.nodeCount);
+
+    for(size_t i = 0; i < g.edgeCount; i++){
+        uint64_t carry = sameColor(g, low, high, i);
+        for(int bit = 0; bit < CONFLICT_BITS; bit++){
+            uint64_t next = counters[bit] & carry;
+            counters[bit] ^= carry;
+            carry = next;
+        }
+        overflow |= carry;
+        if((i & 63) == 63 && overflow == UINT64_MAX){
+            break;
+        }
+    }
+
+    int bestLane = 0;
+    int bestConflicts = NUMBER_OF_SOLUTIONS + 1;
+    for(int lane = 0; lane < LANES; lane++){
+        if((overflow >> lane) & 1){
+            continue;
+        }
+        int conflicts = 0;
+        for(int bit = 0; bit < CONFLICT_BITS; bit++){
+            conflicts |= (int) ((counters[bit] >> lane) & 1) << bit;
+        }
+        if(conflicts < bestConflicts){
+            bestConflicts = conflicts;
+            bestLane = lane;
+        }
+    }
+
+    return bestLane;
+}
+
+/**
+* laneColors function.
+* @brief Copies the colors of one lane of the bit-sliced colorings into a byte per node.
 *
-* @param colorArr array for the colors
-* @param nodesSize size of the array
+* @param low low bit-plane of the colors
+* @param high high bit-plane of the colors
+* @param lane coloring
+* @param colors destination, one color per node
+* @param nodesSize number of nodes
 */
-static void colorPermutation(int *colorArr, int nodesSize){
-    for(int i = 0; i < nodesSize; i++){
-        colorArr[i] = rand() % 3;
+static void laneColors(const uint64_t *low, const uint64_t *high, int lane, unsigned char *colors, size_t nodesSize){
+    for(size_t i = 0; i < nodesSize; i++){
+        colors[i] = (unsigned char) (((low[i] >> lane) & 1) | ((high[i] >> lane) & 1) << 1);
     }
 }
 
 /**
-* reduceEdges function.
-* @brief This function takes in the edges, the nodes and the color permutation;
-*        returning a new edgeArray with edges that caused conflicts on same color.
+* conflictEdges function.
+* @brief Returns the edges whose endpoints have the same color in a coloring (one byte per node).
 *
 * @param edgesArr edges array
-* @param nodesArr nodes array
-* @param colorArr color permutation array
+* @param g graph with dense ids
+* @param colors coloring
+* @param conflicts number of conflicts of the coloring
 * @return a new edgeArray containing the edges to be deleted for 3-coloring (do not forget cleanup!)
 */
-static edgeArray reduceEdges(edgeArray edgesArr, nodesArray nodesArr, int *colorArr){
+static edgeArray conflictEdges(edgeArray edgesArr, graph g, const unsigned char *colors, size_t conflicts){
     edgeArray result;
 
-    result.edges = (edge*) malloc(edgesArr.size * sizeof(edge));
-    int count = 0;
+    result.edges = (edge*) malloc((conflicts > 0 ? conflicts : 1) * sizeof(edge));
+    if(result.edges == NULL){
+        usage("memory allocation failed on creating a solution");
+    }
+    size_t count = 0;
 
-    for(int i=0; i<edgesArr.size; i++){
-        int firstColor = -1;
-        int secondColor = -1;
+    for(size_t i = 0; i < g.edgeCount && count < conflicts; i++){
+        if(colors[g.pairs[2 * i]] == colors[g.pairs[2 * i + 1]]){
+            result.edges[count++] = edgesArr.edges[i];
+        }
+    }
 
-        for(int j=0; j<nodesArr.size; j++){
-            if(edgesArr.edges[i].first == nodesArr.nodes[j]){
-                firstColor = j;
-            }
-            if(edgesArr.edges[i].second == nodesArr.nodes[j]){
-                secondColor = j;
-            }
+    result.size = count;
+    return result;
+}
+
+/**
+* setConflicted function.
+* @brief Adds a node to or removes it from the list of conflicted nodes, according to its conflict counter.
+*
+* @param s search state
+* @param v node
+*/
+static void setConflicted(searchState *s, uint32_t v){
+    int conflicted = s->counts[3 * v + s->colors[v]] > 0;
+    if(conflicted && s->position[v] == -1){
+        s->position[v] = s->conflictedCount;
+        s->conflicted[s->conflictedCount++] = v;
+    }
+    else if(!conflicted && s->position[v] != -1){
+        uint32_t last = s->conflicted[--s->conflictedCount];
+        s->conflicted[s->position[v]] = last;
+        s->position[last] = s->position[v];
+        s->position[v] = -1;
+    }
+}
+
+/**
+* initSearch function.
+* @brief Allocates the state of the local search for a graph.
+*
+* @param g graph with dense ids
+* @return search state (do not forget freeSearch!)
+*/
+static searchState initSearch(graph g){
+    searchState s;
+    s.colors = (unsigned char *) malloc(g.nodeCount + 1);
+    s.counts = (uint32_t *) malloc((3 * g.nodeCount + 1) * sizeof(uint32_t));
+    s.conflicted = (uint32_t *) malloc((g.nodeCount + 1) * sizeof(uint32_t));
+    s.position = (int32_t *) malloc((g.nodeCount + 1) * sizeof(int32_t));
+    s.tabu = (uint64_t *) malloc((3 * g.nodeCount + 1) * sizeof(uint64_t));
+    if(s.colors == NULL || s.counts == NULL || s.conflicted == NULL || s.position == NULL || s.tabu == NULL){
+        usage("memory allocation failed on creating the search state");
+    }
+    s.step = 0;
+    return s;
+}
+
+/**
+* freeSearch function.
+* @brief Frees the state of the local search.
+*
+* @param s search state
+*/
+static void freeSearch(searchState s){
+    free(s.colors);
+    free(s.counts);
+    free(s.conflicted);
+    free(s.position);
+    free(s.tabu);
+}
+
+/**
+* startSearch function.
+* @brief Starts the local search from the coloring in s->colors.
+* @details Fills the conflict counters (one pass over the CSR arrays), the list of conflicted nodes and the number
+*          of conflicts, and clears the tabu list.
+*
+* @param s search state
+* @param g graph with dense ids
+*/
+static void startSearch(searchState *s, graph g){
+    size_t twice = 0; // every conflict edge is counted at both endpoints
+
+    s->conflictedCount = 0;
+    memset(s->counts, 0, 3 * g.nodeCount * sizeof(uint32_t));
+    memset(s->tabu, 0, 3 * g.nodeCount * sizeof(uint64_t));
+
+    for(uint32_t v = 0; v < g.nodeCount; v++){
+        for(uint32_t i = g.offsets[v]; i < g.offsets[v + 1]; i++){
+            s->counts[3 * v + s->colors[g.adjacency[i]]]++;
         }
+        twice += s->counts[3 * v + s->colors[v]];
+        s->position[v] = -1;
+    }
+    s->conflicts = g.selfLoops + twice / 2;
+    for(uint32_t v = 0; v < g.nodeCount; v++){
+        setConflicted(s, v);
+    }
+}
 
-        if(colorArr[firstColor] == colorArr[secondColor]){
-            result.edges[count] = edgesArr.edges[i];
-            count++;
+/**
+* recolor function.
+* @brief Gives a node a new color, updating the counters of its neighbours in O(degree).
+*
+* @param s search state
+* @param g graph with dense ids
+* @param v node
+* @param color new color
+*/
+static void recolor(searchState *s, graph g, uint32_t v, unsigned char color){
+    unsigned char old = s->colors[v];
+
+    s->conflicts += s->counts[3 * v + color];
+    s->conflicts -= s->counts[3 * v + old];
+    s->colors[v] = color;
+    s->tabu[3 * v + old] = s->step + TABU_TENURE + nextRandom() % TABU_TENURE;
+
+    for(uint32_t i = g.offsets[v]; i < g.offsets[v + 1]; i++){
+        uint32_t u = g.adjacency[i];
+        s->counts[3 * u + old]--;
+        s->counts[3 * u + color]++;
+        if(s->colors[u] == old || s->colors[u] == color){
+            setConflicted(s, u);
         }
     }
+    setConflicted(s, v);
+}
 
-    result.size = count;
-    if(count != 0 && count != edgesArr.size){
-        result.edges = (edge *) realloc(result.edges, count * sizeof(edge));
+/**
+* searchStep function.
+* @brief One step of min-conflicts with random walk and a tabu list.
+* @details A random conflicted node is recolored. With probability WALK_PERCENT it takes a random other color,
+*          otherwise the other color with the fewest conflicting neighbours that is not tabu (unless it beats best),
+*          if that does not add conflicts; ties are taken, so the search moves along plateaus.
+*
+* @param s search state (with at least one conflicted node)
+* @param g graph with dense ids
+* @param best fewest conflicts seen in this run
+*/
+static void searchStep(searchState *s, graph g, size_t best){
+    uint32_t v = s->conflicted[nextRandom() % s->conflictedCount];
+    unsigned char current = s->colors[v];
+    unsigned char first = (current + 1) % 3;
+    unsigned char second = (current + 2) % 3;
+    unsigned char color;
+
+    s->step++;
+    if(nextRandom() % 100 < WALK_PERCENT){
+        color = nextRandom() & 1 ? first : second;
     }
-    // result.edges = (edge *) realloc(result.edges, count * sizeof(edge));
+    else{
+        uint32_t here = s->counts[3 * v + current];
+        int firstAllowed = s->tabu[3 * v + first] <= s->step || s->conflicts - here + s->counts[3 * v + first] < best;
+        int secondAllowed = s->tabu[3 * v + second] <= s->step || s->conflicts - here + s->counts[3 * v + second] < best;
 
-    return result;
+        if(firstAllowed && secondAllowed){
+            uint32_t a = s->counts[3 * v + first];
+            uint32_t b = s->counts[3 * v + second];
+            color = a < b ? first : (b < a ? second : (nextRandom() & 1 ? first : second));
+        }
+        else if(firstAllowed || secondAllowed){
+            color = firstAllowed ? first : second;
+        }
+        else{
+            return;
+        }
+        if(s->counts[3 * v + color] > here){ // every allowed color has more conflicts, v keeps its color
+            return;
+        }
+    }
+    recolor(s, g, v, color);
 }
 
 /**
-* createSolution function.
-* @brief This function takes in the edges and the nodes. It creates a color permutation array 
-*        and calls on reduceEdges. 
+* annealingTable function.
+* @brief Fills the acceptance thresholds of a temperature.
+* @details The temperature is given as p, the probability to accept a move adding one conflict, a move adding delta
+*          conflicts is accepted with p^delta (= e^(-delta / T)); acceptance[delta] is that probability scaled to 2^64.
 *
-* @param edgesArr edges array
-* @param nodesArr nodes array
-* @return a new edgeArray containing the edges to be deleted for 3-coloring (do not forget cleanup!)
+* @param p probability to accept one more conflict
+* @param acceptance ANNEAL_DELTAS thresholds
 */
-static edgeArray createSolution(edgeArray edgesArr, nodesArray nodesArr){
-    
-    int colorArr[nodesArr.size];    
-    colorPermutation(colorArr, nodesArr.size);
+static void annealingTable(double p, uint64_t *acceptance){
+    double probability = 1.0;
+
+    for(int delta = 0; delta < ANNEAL_DELTAS; delta++){
+        acceptance[delta] = delta == 0 ? UINT64_MAX : (uint64_t) (probability * 18446744073709551616.0);
+        probability *= p;
+    }
+}
+
+/**
+* annealStep function.
+* @brief One step of simulated annealing.
+* @details A random conflicted node is proposed the other color with the fewest conflicting neighbours (ties broken at
+*          random). Moves that do not add conflicts are always made, a move adding delta conflicts if a random number
+*          is below acceptance[delta] (Metropolis).
+*
+* @param s search state (with at least one conflicted node)
+* @param g graph with dense ids
+* @param acceptance thresholds of annealingTable
+*/
+static void annealStep(searchState *s, graph g, const uint64_t *acceptance){
+    uint32_t v = s->conflicted[nextRandom() % s->conflictedCount];
+    unsigned char current = s->colors[v];
+    unsigned char first = (current + 1) % 3;
+    unsigned char second = (current + 2) % 3;
+    uint32_t a = s->counts[3 * v + first];
+    uint32_t b = s->counts[3 * v + second];
+    unsigned char color = a < b ? first : (b < a ? second : (nextRandom() & 1 ? first : second));
+    uint32_t here = s->counts[3 * v + current];
+    uint32_t there = s->counts[3 * v + color];
 
-    edgeArray reduced = reduceEdges(edgesArr, nodesArr, colorArr);
+    s->step++;
+    if(there > here && (there - here >= ANNEAL_DELTAS || nextRandom() >= acceptance[there - here])){
+        return;
+    }
+    recolor(s, g, v, color);
+}
 
-    return reduced;
+/**
+* futexWait function.
+* @brief Sleeps while a shared word has the given value, at most RING_SLEEP_NS.
+*
+* @param address shared word
+* @param value value seen
+*/
+static void futexWait(unsigned int *address, unsigned int value){
+    struct timespec timeout = {0, RING_SLEEP_NS};
+    syscall(SYS_futex, address, FUTEX_WAIT, value, &timeout, NULL, 0);
+}
 
+/**
+* futexWake function.
+* @brief Wakes all processes sleeping on a shared word.
+*
+* @param address shared word
+*/
+static void futexWake(unsigned int *address){
+    syscall(SYS_futex, address, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/**
+* takeLimit function.
+* @brief Takes one solution from the limit of the supervisor.
+*
+* @param myMemory shared memory
+* @return 1 if a solution may be written, 0 if the limit is reached
+*/
+static int takeLimit(sharedMemory *myMemory){
+    int limit = __atomic_load_n(&myMemory->limit, __ATOMIC_RELAXED);
+    while(limit > 0){
+        if(__atomic_compare_exchange_n(&myMemory->limit, &limit, limit - 1, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+            return 1;
+        }
+    }
+    return limit < 0;
 }
 
 /**
 * writeToSharedMemory function.
 * @brief This function writes a solution to the shared memory. 
-* @details This function should be exclusive.
+* @details Lock-free: a slot is reserved by taking the next writeTicket with compare and swap, once the slot of that
+*          ticket is free (its sequence equals the ticket). The solution is then copied and published by setting the
+*          sequence to ticket + 1, and the supervisor is woken if it sleeps. A generator only sleeps while the ring is full.
 * @param myMemory shared memory
 * @param solution solution with the edges
+* @return 0 on success, -1 if the supervisor has stopped
 */
-static void writeToSharedMemory(sharedMemory *myMemory, edgeArray solution){
+static int writeToSharedMemory(sharedMemory *myMemory, edgeArray solution){
     
     #ifdef DEBUG
         pid_t pid = getpid();
     #endif
 
-    myMemory->edgeArray[myMemory->currentWriting].size = solution.size;
+    unsigned long long ticket = __atomic_load_n(&myMemory->writeTicket, __ATOMIC_RELAXED);
+    solutionSlot *slot;
+    int spins = 0;
+
+    for(;;){
+        if(__atomic_load_n(&myMemory->state, __ATOMIC_RELAXED) == 1){
+            free(solution.edges);
+            return -1;
+        }
+        slot = &myMemory->slots[ticket % MAX_DATA];
+        unsigned int sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        int difference = (int) (sequence - (unsigned int) ticket);
+
+        if(difference == 0){
+            if(__atomic_compare_exchange_n(&myMemory->writeTicket, &ticket, ticket + 1, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+                break;
+            }
+        }
+        else if(difference < 0){ // ring is full, the supervisor has not read this slot yet
+            if(++spins < RING_SPINS){
+                continue;
+            }
+            __atomic_add_fetch(&myMemory->sleepingGenerators, 1, __ATOMIC_SEQ_CST);
+            if(__atomic_load_n(&slot->sequence, __ATOMIC_SEQ_CST) == sequence){
+                futexWait(&slot->sequence, sequence);
+            }
+            __atomic_sub_fetch(&myMemory->sleepingGenerators, 1, __ATOMIC_SEQ_CST);
+            spins = 0;
+            ticket = __atomic_load_n(&myMemory->writeTicket, __ATOMIC_RELAXED);
+        }
+        else{ // another generator took the ticket
+            ticket = __atomic_load_n(&myMemory->writeTicket, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->solution.size = solution.size;
     #ifdef DEBUG
-        fprintf(stdout, "[%d] Writing to [%d] in shared memory a solution of size [%ld]: ", pid, myMemory->currentWriting, solution.size);
+        fprintf(stdout, "[%d] Writing ticket [%llu] in shared memory a solution of size [%ld]: ", pid, ticket, solution.size);
     #endif
     for(int i = 0; i < solution.size; i++){
         #ifdef DEBUG
             fprintf(stdout, "%d-%d ", solution.edges[i].first, solution.edges[i].second);
         #endif
-        myMemory->edgeArray[myMemory->currentWriting].edges[i].first = solution.edges[i].first;
-        myMemory->edgeArray[myMemory->currentWriting].edges[i].second = solution.edges[i].second;
+        slot->solution.edges[i].first = solution.edges[i].first;
+        slot->solution.edges[i].second = solution.edges[i].second;
     }
     #ifdef DEBUG
         fprintf(stdout, "; with current limit: %d\n", myMemory->limit);
     #endif
-        
-    myMemory->currentWriting = (myMemory->currentWriting + 1) % MAX_DATA;
+
+    __atomic_store_n(&slot->sequence, (unsigned int) ticket + 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&myMemory->sleepingSupervisor, __ATOMIC_SEQ_CST) > 0){
+        futexWake(&slot->sequence);
+    }
 
     free(solution.edges);
+    return 0;
+}
+
+/**
+* publishSolution function.
+* @brief Takes one solution from the limit and writes the conflict edges of a coloring to the supervisor.
+*
+* @param myMemory shared memory
+* @param edgesArr edges array
+* @param g graph with dense ids
+* @param colors coloring
+* @param conflicts conflicts of the coloring
+* @param addedAsGenerator set to 1 once this generator is counted in numberOfGenerators
+* @return 0 on success, -1 if the limit is reached or the supervisor has stopped
+*/
+static int publishSolution(sharedMemory *myMemory, edgeArray edgesArr, graph g, const unsigned char *colors, size_t conflicts,
+                           int *addedAsGenerator){
+    if(*addedAsGenerator == 0){
+        *addedAsGenerator = 1;
+        __atomic_add_fetch(&myMemory->numberOfGenerators, 1, __ATOMIC_RELAXED);
+    }
+    if(!takeLimit(myMemory)){
+        return -1;
+    }
+    return writeToSharedMemory(myMemory, conflictEdges(edgesArr, g, colors, conflicts));
+}
+
+/**
+* writeBestState function.
+* @brief Publishes a coloring in the best-state area, if it is better than the one there.
+* @details The seqlock is taken by making bestVersion odd with compare and swap; when another generator writes at the
+*          same time this one gives up, the next exchange tries again. A coloring of another graph is never replaced.
+*
+* @param myMemory shared memory
+* @param hash graphHash of the graph
+* @param colors coloring
+* @param nodesSize number of nodes
+* @param conflicts conflicts of the coloring
+*/
+static void writeBestState(sharedMemory *myMemory, uint64_t hash, const unsigned char *colors, size_t nodesSize, size_t conflicts){
+    int shared = __atomic_load_n(&myMemory->bestConflicts, __ATOMIC_RELAXED);
+    unsigned int version = __atomic_load_n(&myMemory->bestVersion, __ATOMIC_RELAXED);
+
+    if(nodesSize > MAX_SHARED_NODES || (version & 1) || (size_t) shared <= conflicts){
+        return;
+    }
+    if(!__atomic_compare_exchange_n(&myMemory->bestVersion, &version, version + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)){
+        return;
+    }
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    shared = __atomic_load_n(&myMemory->bestConflicts, __ATOMIC_RELAXED);
+    if(shared == INT_MAX || (__atomic_load_n(&myMemory->bestGraph, __ATOMIC_RELAXED) == hash && (size_t) shared > conflicts)){
+        memcpy(myMemory->bestColors, colors, nodesSize);
+        __atomic_store_n(&myMemory->bestGraph, hash, __ATOMIC_RELAXED);
+        __atomic_store_n(&myMemory->bestNodes, (unsigned int) nodesSize, __ATOMIC_RELAXED);
+        __atomic_store_n(&myMemory->bestConflicts, (int) conflicts, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&myMemory->bestVersion, version + 2, __ATOMIC_RELEASE);
+}
+
+/**
+* readBestState function.
+* @brief Copies the coloring of the best-state area, if it belongs to this graph and has fewer conflicts than below.
+* @details The copy is only kept if bestVersion was even and unchanged around it (seqlock), at most EXCHANGE_TRIES
+*          attempts are made.
+*
+* @param myMemory shared memory
+* @param hash graphHash of the graph
+* @param colors destination, one color per node (overwritten even if -1 is returned)
+* @param nodesSize number of nodes
+* @param below conflicts to beat
+* @return conflicts of the copied coloring, -1 if there is none
+*/
+static int readBestState(sharedMemory *myMemory, uint64_t hash, unsigned char *colors, size_t nodesSize, size_t below){
+    for(int tries = 0; tries < EXCHANGE_TRIES; tries++){
+        unsigned int version = __atomic_load_n(&myMemory->bestVersion, __ATOMIC_ACQUIRE);
+        if(version & 1){
+            continue;
+        }
+        int conflicts = __atomic_load_n(&myMemory->bestConflicts, __ATOMIC_RELAXED);
+        if(conflicts == INT_MAX || (size_t) conflicts >= below || nodesSize > MAX_SHARED_NODES
+            || __atomic_load_n(&myMemory->bestGraph, __ATOMIC_RELAXED) != hash
+            || __atomic_load_n(&myMemory->bestNodes, __ATOMIC_RELAXED) != nodesSize){
+            if(__atomic_load_n(&myMemory->bestVersion, __ATOMIC_ACQUIRE) == version){
+                return -1;
+            }
+            continue;
+        }
+        memcpy(colors, myMemory->bestColors, nodesSize);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(__atomic_load_n(&myMemory->bestVersion, __ATOMIC_RELAXED) == version){
+            return conflicts;
+        }
+    }
+    return -1;
 }
 
 int main(int argc, char* argv[])
 {
     int addedAsGenerator = 0;
     progname = argv[0];
-    srand(time(NULL)); // seeding the rand function
+    randomState = ((uint64_t) time(NULL) << 20) ^ (uint64_t) getpid() ^ 0x9E3779B97F4A7C15ULL; // seeding nextRandom
 
-    if(argc == 1){
+    int anneal = 0;
+    int option;
+    while((option = getopt(argc, argv, "a")) != -1){
+        switch(option){
+            case 'a':
+                anneal = 1;
+                break;
+            default:
+                usage("invalid option, synopsis: generator [-a] edge...");
+        }
+    }
+    if(optind == argc){
         usage("no arguments given.");
     }
-    edgeArray edges = handleArguments(argc, argv);
+    edgeArray edges = handleArguments(argc - optind + 1, argv + optind - 1);
     nodesArray nodes = separateNodes(edges);
+    graph g = buildGraph(edges, nodes);
+    uint64_t hash = graphHash(nodes, g);
+    uint64_t *low = (uint64_t *) malloc((g.nodeCount + 1) * sizeof(uint64_t));
+    uint64_t *high = (uint64_t *) malloc((g.nodeCount + 1) * sizeof(uint64_t));
+    unsigned char *bestColors = (unsigned char *) malloc(g.nodeCount + 1);
+    if(low == NULL || high == NULL || bestColors == NULL){
+        usage("memory allocation failed on creating the colorings");
+    }
 
     int shmfd;
     if((shmfd = shm_open(SHM_NAME, O_RDWR, 0600))  == -1){
@@ -365,114 +974,112 @@ int main(int argc, char* argv[])
         usage("error occured while mapping memory.");
     }
 
-    sem_t *freespace = sem_open(SEM_1, 0);
-    if (freespace == SEM_FAILED) {
-        if (munmap(myMemory, sizeof(*myMemory)) == -1) {
-            usage("Error in munmap");
-        }
-        if (close(shmfd) == -1) {
-            usage("Error in close");
-        }
-        if (sem_close(freespace) == -1) {
-            usage("Error in sem_close for freespace");
-        }
-        usage("error on opening the freespace semaphore.");
-    }
-    sem_t *usedspace = sem_open(SEM_2, 0);
-    if (usedspace == SEM_FAILED) {
-        if (munmap(myMemory, sizeof(*myMemory)) == -1) {
-            usage("Error in munmap");
-        }
-        if (close(shmfd) == -1) {
-            usage("Error in close");
-        }
-        if (sem_close(freespace) == -1) {
-            usage("Error in sem_close for freespace");
-        }
-        if (sem_close(usedspace) == -1) {
-            usage("Error in sem_close for usedspace");
-        }
-        usage("error on opening the usedspace semaphore.");
+    if(__atomic_load_n(&myMemory->ready, __ATOMIC_ACQUIRE) != RING_READY){
+        munmap(myMemory, sizeof(*myMemory));
+        close(shmfd);
+        usage("supervisor has not been started.");
     }
-    sem_t *writeacces = sem_open(SEM_3, 0);
-    if (usedspace == SEM_FAILED) {
-        if (munmap(myMemory, sizeof(*myMemory)) == -1) {
-            usage("Error in munmap");
-        }
-        if (close(shmfd) == -1) {
-            usage("Error in close");
-        }
-        if (sem_close(freespace) == -1) {
-            usage("Error in sem_close for freespace");
-        }
-        if (sem_close(usedspace) == -1) {
-            usage("Error in sem_close for usedspace");
-        }
+    
+    searchState search = initSearch(g);
+    size_t best = SIZE_MAX; // fewest conflicts of this run, its coloring is in bestColors
+    size_t published = SIZE_MAX; // conflicts of the coloring of this run last written to the supervisor
+    uint64_t lastImprovement = 0;
+    uint64_t restartSteps = RESTART_STEPS + 100 * (uint64_t) g.nodeCount;
+    uint64_t batches = 0;
+    uint64_t acceptance[ANNEAL_DELTAS];
+    double hottest = ANNEAL_HOTTEST;
+    double temperature = 0.0;
+    size_t islandBest = SIZE_MAX; // fewest conflicts of this island since it last started from random colorings
+    int staleReheats = 0; // reheats in a row that did not improve islandBest
 
-        if (sem_close(writeacces) == -1) {
-            usage("Error in sem_close for writeacces");
+    if(anneal){
+        for(int island = __atomic_fetch_add(&myMemory->islands, 1, __ATOMIC_RELAXED) % ANNEAL_ISLANDS; island > 0; island--){
+            hottest *= ANNEAL_SPREAD;
         }
-        usage("error on opening the writeacces semaphore.");
     }
-    
-    while(myMemory->state != 1){
-        edgeArray solution = createSolution(edges, nodes);
-        
-        // while(solution.size > myMemory->bestSolution){ // essentially a good approach, but timeout related
-        //     free(solution.edges);
-        //     solution = createSolution(edges, nodes);
-        // }
 
-        while(solution.size > NUMBER_OF_SOLUTIONS){
-            free(solution.edges);
-            solution = createSolution(edges, nodes);
-        }
-        
-        if(sem_wait(writeacces) == -1){
-            free(solution.edges);
-            break;
-        }
-        if(myMemory->state == 1){
-            free(solution.edges);    
-            sem_post(writeacces);
-            break;
+    while(__atomic_load_n(&myMemory->state, __ATOMIC_RELAXED) != 1){
+        if(best == SIZE_MAX || best == g.selfLoops // only self loops are left, nothing can be improved in this run
+           || (anneal ? temperature < ANNEAL_COLDEST : search.step - lastImprovement > restartSteps)){ // (re)start
+            if(best <= NUMBER_OF_SOLUTIONS && best != published
+               && publishSolution(myMemory, edges, g, bestColors, best, &addedAsGenerator) == -1){ // result of the run
+                break;
+            }
+            if(anneal && best != SIZE_MAX){ // the best of the run is kept in the best-state area for later reheats
+                writeBestState(myMemory, hash, bestColors, g.nodeCount, best);
+                staleReheats = best < islandBest ? 0 : staleReheats + 1;
+                islandBest = best < islandBest ? best : islandBest;
+            }
+            int shared = anneal ? readBestState(myMemory, hash, search.colors, g.nodeCount, best) : -1; // from the better global best
+            if(shared == -1 && anneal && best != SIZE_MAX && staleReheats < ANNEAL_STALE_REHEATS){ // reheat from the own best
+                memcpy(search.colors, bestColors, g.nodeCount);
+            }
+            else if(shared == -1){ // from the best of 64 random colorings, also when reheating stopped improving
+                laneColors(low, high, sampleColorings(g, low, high), search.colors, g.nodeCount);
+                islandBest = SIZE_MAX;
+                staleReheats = 0;
+            }
+            startSearch(&search, g);
+            best = SIZE_MAX;
+            published = SIZE_MAX;
+            lastImprovement = search.step;
+            temperature = hottest;
         }
+        size_t previous = best;
 
-        if(addedAsGenerator == 0){
-            addedAsGenerator = 1;
-            myMemory->numberOfGenerators = myMemory->numberOfGenerators + 1;
-        }
-        if(sem_wait(freespace) == -1){
-            free(solution.edges);
-            break;
-        }
-        if(myMemory->limit != 0){
-            myMemory->limit = myMemory->limit - 1;
-            writeToSharedMemory(myMemory, solution);
-	    
+        if(anneal){ // the coloring moves away from its best, which is kept on every improvement
+            annealingTable(temperature, acceptance);
+            temperature *= ANNEAL_COOLING;
+            for(int i = 0; ; i++){
+                if(search.conflicts < best){
+                    best = search.conflicts;
+                    lastImprovement = search.step;
+                    memcpy(bestColors, search.colors, g.nodeCount);
+                }
+                if(i == SEARCH_BATCH || search.conflicts == g.selfLoops){
+                    break;
+                }
+                annealStep(&search, g, acceptance);
+            }
         }
         else{
-            free(solution.edges);
+            for(int i = 0; i < SEARCH_BATCH && search.conflicts > g.selfLoops && search.conflicts >= best; i++){
+                searchStep(&search, g, best);
+            }
+            if(search.conflicts < best){
+                best = search.conflicts;
+                lastImprovement = search.step;
+                memcpy(bestColors, search.colors, g.nodeCount);
+            }
         }
-        
-        if(sem_post(usedspace) == -1){
-            break;
+
+        if(++batches % EXCHANGE_BATCHES == 0){
+            writeBestState(myMemory, hash, bestColors, g.nodeCount, best);
         }
-        if(sem_post(writeacces) == -1){
-            break;
+        if(best >= previous){
+            continue;
         }
 
-        if(myMemory->limit == 0){
-            break;
+        if(best <= NUMBER_OF_SOLUTIONS && best < (size_t) __atomic_load_n(&myMemory->bestSolution, __ATOMIC_RELAXED)){
+            if(publishSolution(myMemory, edges, g, bestColors, best, &addedAsGenerator) == -1){
+                break;
+            }
+            published = best;
         }
     }
     
+    freeSearch(search);
+    
     free(edges.edges);
     free(nodes.nodes);
+    freeGraph(g);
+    free(low);
+    free(high);
+    free(bestColors);
 
-    // sem_wait(writeacces);
-    // myMemory->numberOfGenerators = myMemory->numberOfGenerators - 1;
-    // sem_post(writeacces);
+    if(addedAsGenerator){
+        __atomic_sub_fetch(&myMemory->numberOfGenerators, 1, __ATOMIC_RELAXED);
+    }
 
     if (munmap(myMemory, sizeof(*myMemory)) == -1) {
         usage("Error in munmap");
@@ -481,18 +1088,6 @@ int main(int argc, char* argv[])
     if (close(shmfd) == -1) {
         usage("Error in close");
     }
-    
-    if (sem_close(freespace) == -1) {
-        usage("Error in sem_close for freespace");
-    }
-
-    if (sem_close(usedspace) == -1) {
-        usage("Error in sem_close for usedspace");
-    }
-
-    if (sem_close(writeacces) == -1) {
-        usage("Error in sem_close for writeacces");
-    }
 
     return 0;
 
@@ -0,0 +1,90 @@
+/**
+ * @file shared.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 22.10.2023
+ *
+ * @brief The shared memory object of supervisor and generator.
+ *
+ * @details The supervisor creates and initializes the shared memory object, the generators write their solutions into
+ *          its ring and exchange their best colorings in its best-state area.
+ * **/
+
+#ifndef SHARED_H
+#define SHARED_H
+
+#define MAX_DATA (100) // maximal buffer
+#define SHM_NAME "/shared_12127678" // shared memory name
+#define NUMBER_OF_SOLUTIONS (20) // maximal size of one solution
+#define RING_READY (0x3C010AC7) // set by the supervisor once the ring is initialized
+#define RING_SPINS (1000) // polls of a slot (full for a generator, empty for the supervisor) before sleeping
+#define RING_SLEEP_NS (100000000) // longest futex sleep, the state is checked after it (100 ms)
+#define CACHE_LINE (64)
+#define MAX_SHARED_NODES (65536) // largest graph (nodes) whose best coloring is exchanged between generators
+
+/**
+ * @struct edge
+ * @brief This structure represents an edge in a graph.
+ */
+typedef struct{
+    int first;
+    int second;
+} edge;
+
+/**
+ * @struct solutionEdgeArr
+ * @brief This structure represents an array of edges to be written to the shared memory. edges array is limited.
+ */
+typedef struct{
+    edge edges[NUMBER_OF_SOLUTIONS];
+    size_t size;
+} solutionEdgeArr;
+
+/**
+ * @struct solutionSlot
+ * @brief This structure represents one slot of the solution ring.
+ * @details sequence is the ticket of the slot while it is free, the ticket + 1 once the solution is published and
+ *          the ticket + MAX_DATA once the supervisor has read it (all modulo 2^32). Sleepers wait on it with a futex.
+ */
+typedef struct{
+    unsigned int sequence;
+    solutionEdgeArr solution;
+} solutionSlot;
+
+/**
+ * @struct sharedMemory
+ * @brief This structure represents the shared memory object. 
+ * @details state is 0 initially. 1 will be set, when the limit is reached or the supervisor found a solution.
+ *          ready is RING_READY once the supervisor has initialized the ring.
+ *          writeTicket is the next ticket reserved by a generator, readTicket the next ticket read by the supervisor,
+ *          a ticket is stored in slot ticket % MAX_DATA. Both are on their own cache line.
+ *          sleepingGenerators and sleepingSupervisor count the sleepers, so futex wakes are only made for them.
+ *          numberOfGenerators is the number of currently running generators.
+ *          limit is the limit set by the supervisor, maximal number of solutions to be written (-1 for no limit).
+ *          slots is the solutions ring.
+ *          The best-state area is a seqlock: bestVersion is odd while a generator writes it. bestColors is the coloring
+ *          (one byte per dense node id) with the fewest conflicts found, bestConflicts its conflicts (INT_MAX if empty),
+ *          bestGraph the hash of its graph and bestNodes its number of nodes. islands counts the annealing generators.
+ */
+typedef struct{
+    int state;
+    int ready;
+    int numberOfGenerators;
+    int bestSolution;
+    int limit;
+    int sleepingGenerators;
+    int sleepingSupervisor;
+    char padding1[CACHE_LINE];
+    unsigned long long writeTicket;
+    char padding2[CACHE_LINE];
+    unsigned long long readTicket;
+    char padding3[CACHE_LINE];
+    solutionSlot slots[MAX_DATA];
+    int islands;
+    unsigned int bestVersion;
+    int bestConflicts;
+    unsigned int bestNodes;
+    unsigned long long bestGraph;
+    unsigned char bestColors[MAX_SHARED_NODES];
+} sharedMemory;
+
+#endif
@@ -7,10 +7,10 @@
  * 
  * @details supervisor [-n limit] [-w delay] [-p]
  *          If limit is specified, the generators will produce only limit amount of solutions.
- *          If delay is specified, the supervisor will start the shared memory and semaphores and wait delay time, in order to let generators create solutions.
+ *          If delay is specified, the supervisor will start the shared memory and wait delay time, in order to let generators create solutions.
  *          If p is specified, a graph will be drawn.
  *          The supervisor program opens and maps the memory to be used as a circular buffer.
- *          Further on, it will open semaphores that ensure non-blocking.
+ *          The buffer is a lock-free ring written by many generators and read by the supervisor, which sleeps (on a futex) only while it is empty.
  *          It will read created solutions, and print the best solutions to the stderr.
  *          If the graph is not 3-coloring compatible, it will work for ever, or until the limit is reached, or until CTRL+C or CTRL+D is given.
  *          
@@ -19,63 +19,21 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
-#include <semaphore.h>
 #include <fcntl.h>
+#include <time.h>
 #include <sys/mman.h>
 #include <sys/types.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 #include <limits.h>
 #include <signal.h>
 #include <string.h>
 
-#define SEM_1 "/sem_1_12127678" // freespace
-#define SEM_2 "/sem_2_12127678" // usedspace
-#define SEM_3 "/sem_3_12127678" // writing privileges
-
-#define MAX_DATA (100)
-#define SHM_NAME "/shared_12127678"
-#define NUMBER_OF_SOLUTIONS (20)
+#include "shared.h"
 
 static char *progname;
 static volatile sig_atomic_t quit = 0;
 
-/**
- * @struct edge
- * @brief This structure represents an edge in a graph.
- */
-typedef struct{
-    int first;
-    int second;
-} edge;
-
-/**
- * @struct solutionEdgeArr
- * @brief This structure represents an array of edges to be written to the shared memory. edges array is limited.
- */
-typedef struct{
-    edge edges[NUMBER_OF_SOLUTIONS];
-    size_t size;
-} solutionEdgeArr;
-
-/**
- * @struct sharedMemory
- * @brief This structure represents the shared memory object. 
- * @details state is 1 initially. 0 will be set, when the limit is reached or the supervisor found a solution.
- *          currentReading is the current reading element by the supervisor.
- *          currentWriting is the current writing element by the generator.
- *          numberOfGenerators is the number of currently running generators.
- *          limit is the limit set by the supervisor, maximal number of solutions to be written.
- *          edgeArray is the solutions array.
- */
-typedef struct{
-    int state;
-    int currentReading;
-    int currentWriting;
-    int numberOfGenerators;
-    int bestSolution;
-    int limit;
-    solutionEdgeArr edgeArray[MAX_DATA];
-} sharedMemory;
-
 /**
 * Usage function.
 * @brief Prints a message to stderr and stops the program with EXIT_FAILURE.
@@ -154,10 +112,84 @@ static void handle_signal(int signal)
 	quit = 1;
 }
 
+/**
+* futexWait function.
+* @brief Sleeps while a shared word has the given value, at most RING_SLEEP_NS or until a signal arrives.
+*
+* @param address shared word
+* @param value value seen
+*/
+static void futexWait(unsigned int *address, unsigned int value){
+    struct timespec timeout = {0, RING_SLEEP_NS};
+    syscall(SYS_futex, address, FUTEX_WAIT, value, &timeout, NULL, 0);
+}
+
+/**
+* futexWake function.
+* @brief Wakes all processes sleeping on a shared word.
+*
+* @param address shared word
+*/
+static void futexWake(unsigned int *address){
+    syscall(SYS_futex, address, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/**
+* readFromSharedMemory function.
+* @brief Waits for the next solution of the ring.
+* @details The solution of readTicket is published once the sequence of its slot is readTicket + 1.
+*          The supervisor polls the slot RING_SPINS times and then sleeps on its sequence until it changes.
+*
+* @param myMemory shared memory
+* @return next solution, NULL if quit was set while waiting
+*/
+static solutionEdgeArr *readFromSharedMemory(sharedMemory *myMemory){
+    solutionSlot *slot = &myMemory->slots[myMemory->readTicket % MAX_DATA];
+    unsigned int published = (unsigned int) myMemory->readTicket + 1;
+    int spins = 0;
+
+    for(;;){
+        unsigned int sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if(sequence == published){
+            return &slot->solution;
+        }
+        if(quit){
+            return NULL;
+        }
+        if(++spins < RING_SPINS){
+            continue;
+        }
+        __atomic_add_fetch(&myMemory->sleepingSupervisor, 1, __ATOMIC_SEQ_CST);
+        if(__atomic_load_n(&slot->sequence, __ATOMIC_SEQ_CST) == sequence){
+            futexWait(&slot->sequence, sequence);
+        }
+        __atomic_sub_fetch(&myMemory->sleepingSupervisor, 1, __ATOMIC_SEQ_CST);
+        spins = 0;
+    }
+}
+
+/**
+* releaseSolution function.
+* @brief Frees the slot of the solution just read for the generators.
+* @details The sequence of the slot becomes readTicket + MAX_DATA, the ticket that will be stored in it next.
+*          Generators sleeping on the full ring are woken.
+*
+* @param myMemory shared memory
+*/
+static void releaseSolution(sharedMemory *myMemory){
+    solutionSlot *slot = &myMemory->slots[myMemory->readTicket % MAX_DATA];
+
+    __atomic_store_n(&slot->sequence, (unsigned int) myMemory->readTicket + MAX_DATA, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&myMemory->readTicket, myMemory->readTicket + 1, __ATOMIC_RELAXED);
+    if(__atomic_load_n(&myMemory->sleepingGenerators, __ATOMIC_SEQ_CST) > 0){
+        futexWake(&slot->sequence);
+    }
+}
+
 /**
  * main function
  * @brief This is the entry point of the ./supervisor program
- *        It creates the necessary resources, like shared-memory, semaphores, signal declaration.
+ *        It creates the necessary resources, like shared-memory, signal declaration.
  *        It then waits for solutions to be created and reads from them, handling them in a way of finding the best solution or reaching a limit.
  *          
  * @param argc number of arguments
@@ -208,45 +240,29 @@ int main(int argc, char* argv[])
     fprintf(stderr, "Memory size: %zu\n", sizeof(*myMemory));
     #endif
     
+    __atomic_store_n(&myMemory->ready, 0, __ATOMIC_RELAXED);
     myMemory->state = 0;
-    myMemory->currentReading = 0;
-    myMemory->currentWriting = 0;
+    myMemory->writeTicket = 0;
+    myMemory->readTicket = 0;
     myMemory->numberOfGenerators = 0;
-
-    sem_t *freespace = sem_open(SEM_1, O_CREAT | O_EXCL, 0600, MAX_DATA);
-    if (freespace == SEM_FAILED) {
-        munmap(myMemory, sizeof(*myMemory));
-        close(shmfd);
-        sem_unlink(SEM_1);
-        usage("error on opening the freespace semaphore.");
-    }
-
-    sem_t *usedspace = sem_open(SEM_2, O_CREAT | O_EXCL, 0600, 0);
-    if (usedspace == SEM_FAILED) {
-        munmap(myMemory, sizeof(*myMemory));
-        close(shmfd);
-        sem_unlink(SEM_1);
-        sem_unlink(SEM_2);
-        usage("error on opening the usedspace semaphore.");
-    }
-
-    sem_t *writeacces = sem_open(SEM_3, O_CREAT | O_EXCL, 0600, 1);
-    if (usedspace == SEM_FAILED) {
-        munmap(myMemory, sizeof(*myMemory));
-        close(shmfd);
-        sem_unlink(SEM_1);
-        sem_unlink(SEM_2);
-        sem_unlink(SEM_3);
-        usage("error on opening the writeacces semaphore.");
+    myMemory->sleepingGenerators = 0;
+    myMemory->sleepingSupervisor = 0;
+    myMemory->islands = 0;
+    myMemory->bestVersion = 0;
+    myMemory->bestConflicts = INT_MAX;
+    myMemory->bestNodes = 0;
+    myMemory->bestGraph = 0;
+    for(int i = 0; i < MAX_DATA; i++){
+        myMemory->slots[i].sequence = i;
     }
 
     int best_size = NUMBER_OF_SOLUTIONS + 1;
     int found = 0;
+    int read = 0;
     myMemory->bestSolution = NUMBER_OF_SOLUTIONS + 1;
 
     myMemory->limit = limit;
-
-    int freespaceSem = 0;
+    __atomic_store_n(&myMemory->ready, RING_READY, __ATOMIC_RELEASE);
 
     if(delay != -1){
         sleep(delay);
@@ -254,11 +270,12 @@ int main(int argc, char* argv[])
 
     while(!quit){
 
-        if(sem_wait(usedspace) == -1){
-            quit = 1;
+        solutionEdgeArr *solution = NULL;
+        if(limit == -1 || read < limit){
+            solution = readFromSharedMemory(myMemory);
         }
 
-        if(quit == 1){
+        if(solution == NULL){
             if(!found){
                 if(best_size != (NUMBER_OF_SOLUTIONS+1)){
                     fprintf(stdout, "The graph might not be 3-colorable, best solution removes %d edges.\n", best_size);
@@ -266,103 +283,35 @@ int main(int argc, char* argv[])
                 else{
                     fprintf(stdout, "No solutions were registered.\n");
                 }
-                myMemory->state = 1;
             }
             break;
         }
 
-        if(myMemory->edgeArray[myMemory->currentReading].size < best_size){
-            best_size = myMemory->edgeArray[myMemory->currentReading].size;
+        if(solution->size < best_size){
+            best_size = solution->size;
             myMemory->bestSolution = best_size;
             if(best_size == 0){
                 found = 1;
                 fprintf(stdout, "The graph is 3-colorable!\n");
-                myMemory->state = 1;
-                if(sem_post(freespace) == -1){
-                    freespaceSem = 282;
-                }
+                releaseSolution(myMemory);
                 break;
             }
             else{
                 fprintf(stderr, "Solution with %d edges: ", best_size);
 
                 for(int i=0; i<best_size; i++){
-                    fprintf(stderr, "%d-%d ", myMemory->edgeArray[myMemory->currentReading].edges[i].first, myMemory->edgeArray[myMemory->currentReading].edges[i].second);
+                    fprintf(stderr, "%d-%d ", solution->edges[i].first, solution->edges[i].second);
                 }
                 fprintf(stderr, "\n");
             }
         }
-        myMemory->currentReading = (myMemory->currentReading + 1) % MAX_DATA;
-
-        if(myMemory->limit == 0 && ((((myMemory->currentReading)) % MAX_DATA) == myMemory->currentWriting)){
-            if(!found){
-                
-                fprintf(stdout, "The graph might not be 3-colorable, best solution removes %d edges.\n", best_size);
-            }
-            myMemory->state = 1;
-            if(sem_post(freespace) == -1){
-                freespaceSem = 304;    
-            }
-            break;
-        }
-
-        if(sem_post(freespace) == -1){
-            freespaceSem = 310;
-            myMemory->state = 1;
-            break;
-        }
-    }
-
-    // while(myMemory->numberOfGenerators != 0){
-    //     if(sem_post(freespace) == -1){
-    //         freespaceSem = 318;
-    //         break;
-    //     }
-    // }
-    int numGenerator = myMemory->numberOfGenerators;
-    for(int i = 0; i < numGenerator; i++){
-        sem_post(freespace);
-        sem_post(writeacces);
-    }
-
-    // munmap(myMemory, sizeof(*myMemory));
-    // close(shmfd);
-    // shm_unlink(SHM_NAME);
-
-    // sem_unlink(SEM_1);
-    // sem_unlink(SEM_2);
-    // sem_unlink(SEM_3);
-    // sem_close(freespace);
-    // sem_close(usedspace);
-    // sem_close(writeacces);
-
-    if(freespaceSem != 0){
-        fprintf(stderr, "error: %d\n", freespaceSem);
-        usage("freespace semaphore caused an error");
-    }
-
-    if (sem_close(freespace) == -1) {
-        usage("Error in sem_close for freespace");
+        releaseSolution(myMemory);
+        read++;
     }
 
-    if (sem_close(usedspace) == -1) {
-        usage("Error in sem_close for usedspace");
-    }
-
-    if (sem_close(writeacces) == -1) {
-        usage("Error in sem_close for writeacces");
-    }
-
-    if (sem_unlink(SEM_1) == -1) {
-        usage("Error in sem_unlink for SEM_1");
-    }
-
-    if (sem_unlink(SEM_2) == -1) {
-        usage("Error in sem_unlink for SEM_2");
-    }
-
-    if (sem_unlink(SEM_3) == -1) {
-        usage("Error in sem_unlink for SEM_3");
+    __atomic_store_n(&myMemory->state, 1, __ATOMIC_SEQ_CST); // stops the generators, sleeping ones are woken
+    for(int i = 0; i < MAX_DATA; i++){
+        futexWake(&myMemory->slots[i].sequence);
     }
 
     if (close(shmfd) == -1) {
@@ -379,4 +328,4 @@ int main(int argc, char* argv[])
 
     return 0;
 
-}
\ No newline at end of file
+}
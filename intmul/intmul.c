@@ -23,15 +23,34 @@
  *                  (ab, 12) = a * 16^2 + 14 * 16^1 + b * 16^1 + 16
  *                  (ab, 12) = a00 + 140 + b0 + 16
  *                  (ab, 12) = c06 = ab * 12
+ *
+ *          Optionally, sub-products can be cached across processes and runs. If INTMUL_CACHE names a file, it is mapped
+ *          as a shared, size bounded (set associative, LRU) cache keyed by a hash of both operands. Every parent checks it
+ *          before forking a child for a sub-product and stores its own result after calculateResult.
+ *          The root process reports the cache hit rate of its run to stderr.
  **/
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <strings.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <fcntl.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+// region: PRODUCT_CACHE
+#define CACHE_ENV "INTMUL_CACHE" // path of the cache file, caching is disabled if not set
+#define CACHE_CHILD_ENV "INTMUL_CHILD" // set for all child processes, only the root reports the hit rate
+#define CACHE_MAGIC (0x494d4331) // "IMC1"
+#define CACHE_SETS (1024) // number of sets
+#define CACHE_WAYS (4) // entries per set
+#define CACHE_MAX_DIGITS (64) // maximal length of a cached operand
 
 /**
  * Structure of a hexadecimal pair
@@ -43,12 +62,49 @@ typedef struct{
     size_t length;
 } HeximalPair;
 
+/**
+ * Structure of a cache entry
+ * @brief One cached sub-product. An entry is empty if its first operand is empty.
+ */
+typedef struct{
+    uint64_t hash;
+    uint64_t lastUsed;
+    char first[CACHE_MAX_DIGITS + 1];
+    char second[CACHE_MAX_DIGITS + 1];
+    char result[2 * CACHE_MAX_DIGITS + 1];
+} CacheEntry;
+
+/**
+ * Structure of the product cache
+ * @brief The layout of the memory-mapped cache file.
+ * @details clock is increased on every access and used for the LRU replacement inside of a set.
+ *          hits and misses are counted over all processes and runs.
+ */
+typedef struct{
+    uint32_t magic;
+    uint32_t size;
+    uint64_t clock;
+    uint64_t hits;
+    uint64_t misses;
+    CacheEntry entries[CACHE_SETS][CACHE_WAYS];
+} ProductCache;
+
 /**
  * Pipes used by the parent process.
  * @brief 
  */
 int parent_pipe[4][2];
 
+/**
+ * Mapped product cache, NULL if caching is disabled.
+ */
+ProductCache *cache = NULL;
+
+/**
+ * File descriptor of the cache file, used for locking.
+ */
+int cache_fd = -1;
+
 /**
  * Wait function.
  * @brief This function is intended for the parent process and it waits on the child processes.
@@ -76,6 +132,207 @@ void usage(char *error){
     exit(EXIT_FAILURE);
 }
 
+/**
+ * Open Cache function.
+ * @brief This function maps the cache file named by INTMUL_CACHE, if set.
+ * @details The file is created and initialized if it does not exist or has a different layout.
+ *          The cache is optional, on any failure a warning is printed and the program continues without it.
+ */
+void openCache(void){
+    char *path = getenv(CACHE_ENV);
+    if(path == NULL || path[0] == '\0'){
+        return;
+    }
+
+    cache_fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if(cache_fd == -1){
+        fprintf(stderr, "./intmul: could not open cache file, caching disabled.\n");
+        return;
+    }
+
+    flock(cache_fd, LOCK_EX);
+
+    struct stat st;
+    if(fstat(cache_fd, &st) == -1 || (st.st_size != sizeof(ProductCache) && ftruncate(cache_fd, sizeof(ProductCache)) == -1)){
+        flock(cache_fd, LOCK_UN);
+        close(cache_fd);
+        cache_fd = -1;
+        fprintf(stderr, "./intmul: could not resize cache file, caching disabled.\n");
+        return;
+    }
+
+    cache = mmap(NULL, sizeof(ProductCache), PROT_READ | PROT_WRITE, MAP_SHARED, cache_fd, 0);
+    if(cache == MAP_FAILED){
+        cache = NULL;
+        flock(cache_fd, LOCK_UN);
+        close(cache_fd);
+        cache_fd = -1;
+        fprintf(stderr, "./intmul: could not map cache file, caching disabled.\n");
+        return;
+    }
+
+    if(cache->magic != CACHE_MAGIC || cache->size != sizeof(ProductCache)){
+        memset(cache, 0, sizeof(ProductCache));
+        cache->magic = CACHE_MAGIC;
+        cache->size = sizeof(ProductCache);
+    }
+
+    flock(cache_fd, LOCK_UN);
+}
+
+/**
+ * Close Cache function.
+ * @brief This function unmaps and closes the cache, if opened.
+ */
+void closeCache(void){
+    if(cache == NULL){
+        return;
+    }
+    munmap(cache, sizeof(ProductCache));
+    close(cache_fd);
+    cache = NULL;
+    cache_fd = -1;
+}
+
+/**
+ * Cache Key function.
+ * @brief This function orders two operands and hashes them (FNV-1a).
+ * @details Multiplication is commutative, so (a, b) and (b, a) share one entry.
+ * @param first first operand.
+ * @param second second operand.
+ * @param length number of digits of each operand.
+ * @param low set to the smaller operand.
+ * @param high set to the greater operand.
+ * @return hash of the ordered pair (never 0).
+ */
+uint64_t cacheKey(char *first, char *second, size_t length, char **low, char **high){
+    if(strncasecmp(first, second, length) <= 0){
+        *low = first;
+        *high = second;
+    } else {
+        *low = second;
+        *high = first;
+    }
+
+    uint64_t hash = 14695981039346656037ULL;
+    for(size_t i = 0; i < length; i++){
+        hash = (hash ^ (unsigned char)tolower((*low)[i])) * 1099511628211ULL;
+    }
+    hash = (hash ^ '*') * 1099511628211ULL;
+    for(size_t i = 0; i < length; i++){
+        hash = (hash ^ (unsigned char)tolower((*high)[i])) * 1099511628211ULL;
+    }
+
+    return hash == 0 ? 1 : hash;
+}
+
+/**
+ * Cache Entry Matches function.
+ * @brief This function compares an entry with an ordered pair of operands.
+ * @return 1 on match, 0 otherwise.
+ */
+int cacheEntryMatches(CacheEntry *entry, uint64_t hash, char *low, char *high, size_t length){
+    return entry->hash == hash && strlen(entry->first) == length
+        && strncasecmp(entry->first, low, length) == 0 && strncasecmp(entry->second, high, length) == 0;
+}
+
+/**
+ * Cache Lookup function.
+ * @brief This function looks up the product of two operands in the cache.
+ * @param first first operand (may be followed by a '\n').
+ * @param second second operand (may be followed by a '\n').
+ * @param length number of digits of each operand.
+ * @return Upon a hit a copy of the product is returned, otherwise NULL.
+ * @warning The caller is responsible for freeing the result.
+ */
+char* cacheLookup(char *first, char *second, size_t length){
+    if(cache == NULL || length > CACHE_MAX_DIGITS){
+        return NULL;
+    }
+
+    char *low, *high;
+    uint64_t hash = cacheKey(first, second, length, &low, &high);
+    CacheEntry *set = cache->entries[hash % CACHE_SETS];
+    char *result = NULL;
+
+    flock(cache_fd, LOCK_EX);
+    for(int i = 0; i < CACHE_WAYS; i++){
+        if(cacheEntryMatches(&set[i], hash, low, high, length)){
+            set[i].lastUsed = ++cache->clock;
+            result = strdup(set[i].result);
+            break;
+        }
+    }
+    if(result != NULL){
+        cache->hits++;
+    } else {
+        cache->misses++;
+    }
+    flock(cache_fd, LOCK_UN);
+
+    return result;
+}
+
+/**
+ * Cache Insert function.
+ * @brief This function stores the product of two operands in the cache.
+ * @details The least recently used entry of the set is replaced.
+ * @param first first operand.
+ * @param second second operand.
+ * @param length number of digits of each operand.
+ * @param result product of both operands.
+ */
+void cacheInsert(char *first, char *second, size_t length, char *result){
+    if(cache == NULL || length > CACHE_MAX_DIGITS || strlen(result) > 2 * CACHE_MAX_DIGITS){
+        return;
+    }
+
+    char *low, *high;
+    uint64_t hash = cacheKey(first, second, length, &low, &high);
+    CacheEntry *set = cache->entries[hash % CACHE_SETS];
+
+    flock(cache_fd, LOCK_EX);
+    CacheEntry *victim = &set[0];
+    for(int i = 0; i < CACHE_WAYS; i++){
+        if(cacheEntryMatches(&set[i], hash, low, high, length) || set[i].first[0] == '\0'){
+            victim = &set[i];
+            break;
+        }
+        if(set[i].lastUsed < victim->lastUsed){
+            victim = &set[i];
+        }
+    }
+
+    victim->hash = hash;
+    victim->lastUsed = ++cache->clock;
+    memcpy(victim->first, low, length);
+    victim->first[length] = '\0';
+    memcpy(victim->second, high, length);
+    victim->second[length] = '\0';
+    strcpy(victim->result, result);
+    flock(cache_fd, LOCK_UN);
+}
+
+/**
+ * Report Cache function.
+ * @brief This function prints the hit rate of this run to stderr.
+ * @param hits hits counted before the run.
+ * @param misses misses counted before the run.
+ */
+void reportCache(uint64_t hits, uint64_t misses){
+    if(cache == NULL){
+        return;
+    }
+    flock(cache_fd, LOCK_SH);
+    hits = cache->hits - hits;
+    misses = cache->misses - misses;
+    flock(cache_fd, LOCK_UN);
+
+    uint64_t total = hits + misses;
+    fprintf(stderr, "./intmul: cache hits %llu/%llu (%.1f%%)\n", (unsigned long long)hits, (unsigned long long)total,
+            total == 0 ? 0.0 : 100.0 * hits / total);
+}
+
 /**
  * Check Input function.
  * @brief This function checks the given input and validates it. 
@@ -333,11 +590,14 @@ void writeToPipe(int fd, char *number1, char *number2){
  *          Creates the pipes using pipe() and redirects them using dup2().
  *          Child processes will be executed with execlp as ./intmul.
  *          The parent process writes the corresponding input to every child (one of the four parts)
+ *          Parts whose product is found in the cache are not forked, their result is stored in results directly
+ *          and the corresponding parent_pipe is set to -1.
  *          Fails if fork(), pipe(), dup2() or execlp() fails.
  *          
  * @param pair Hexadecimal pair with length of >= 2.
+ * @param results 4 Element array where cached products will be stored, NULL for every forked part
  */
-void forkPipe(HeximalPair *pair){
+void forkPipe(HeximalPair *pair, char **results){
 
     char *Ah;
     char *Al;
@@ -353,8 +613,20 @@ void forkPipe(HeximalPair *pair){
     pid_t process_id[4];
     int child_pipe[4][2];
 
+    char *firstParts[4] = {Ah, Ah, Al, Al};
+    char *secondParts[4] = {Bh, Bl, Bh, Bl};
+
     for(int i=0; i<4; i++){
 
+        results[i] = NULL;
+        if(pair->length / 2 > 1){
+            results[i] = cacheLookup(firstParts[i], secondParts[i], pair->length / 2);
+        }
+        if(results[i] != NULL){
+            parent_pipe[i][0] = -1;
+            continue;
+        }
+
         pipe(child_pipe[i]);
         pipe(parent_pipe[i]);
 
@@ -393,30 +665,8 @@ void forkPipe(HeximalPair *pair){
             close(child_pipe[i][0]);
             close(parent_pipe[i][1]);
 
-            int pipe_to_write = child_pipe[i][1];
-
-            switch (i)
-            {
-            case 0:
-                writeToPipe(pipe_to_write, Ah, Bh);
-                break;
-            
-            case 1:
-                writeToPipe(pipe_to_write, Ah, Bl);
-                break;
-
-            case 2: 
-                writeToPipe(pipe_to_write, Al, Bh);
-                break;
+            writeToPipe(child_pipe[i][1], firstParts[i], secondParts[i]);
 
-            case 3:
-                writeToPipe(pipe_to_write, Al, Bl);
-                break;
-            
-            default:
-                break;
-            }
-            
         }
     }
 
@@ -541,12 +791,16 @@ char* calculateResult(char *first, char *second, char *third, char *fourth, size
 /**
  * Read from pipes function
  * @brief This function reads from the output pipes and assigns them to the results array.
+ *        Elements already set (cache hits) are skipped. Every pipe read is closed and its fd set to -1.
  *          
  * @param results 4 Element array where the reads will be stored
  */
 void read_from_pipes(char **results){
     for (int i = 0; i < 4; i++)
     {
+        if(results[i] != NULL){
+            continue;
+        }
         FILE *out = fdopen(parent_pipe[i][0], "r");
         size_t lencap = 0;
         ssize_t len = 0;
@@ -557,8 +811,8 @@ void read_from_pipes(char **results){
         
         results[i] = tempLine;
         results[i][len - 1] = '\0';
-        close(parent_pipe[i][0]);
-        fclose(out);
+        fclose(out); // closes parent_pipe[i][0] as well
+        parent_pipe[i][0] = -1;
     }
 }
 
@@ -592,25 +846,68 @@ int main(int argc, char* argv[]){
     if(pair.length == 1){
         runBaseCase(&pair);
     }
-    forkPipe(&pair);
 
-    waitOnChildren();
-    
+    openCache();
+
+    int isRoot = getenv(CACHE_CHILD_ENV) == NULL;
+    uint64_t startHits = 0, startMisses = 0;
+    char *cacheFirst = NULL, *cacheSecond = NULL;
+
+    if(cache != NULL){
+        flock(cache_fd, LOCK_SH);
+        startHits = cache->hits;
+        startMisses = cache->misses;
+        flock(cache_fd, LOCK_UN);
+
+        if(isRoot){
+            char *cached = cacheLookup(pair.first, pair.second, pair.length);
+            if(cached != NULL){
+                fprintf(stdout, "%s\n", cached);
+                fflush(stdout);
+                reportCache(startHits, startMisses);
+                free(cached);
+                free(pair.first);
+                free(pair.second);
+                closeCache();
+                exit(EXIT_SUCCESS);
+            }
+            setenv(CACHE_CHILD_ENV, "1", 1);
+        }
+
+        cacheFirst = strdup(pair.first);
+        cacheSecond = strdup(pair.second);
+    }
+
     char *results[4];
 
+    forkPipe(&pair, results);
+
+    waitOnChildren();
+
     read_from_pipes(results);
     
     char *result = calculateResult(results[0], results[1], results[2], results[3], pair.length);
     
     fprintf(stdout, "%s\n", result);
+
+    if(cache != NULL){
+        cacheInsert(cacheFirst, cacheSecond, pair.length, result);
+        if(isRoot){
+            reportCache(startHits, startMisses);
+        }
+        free(cacheFirst);
+        free(cacheSecond);
+        closeCache();
+    }
     
     free(result);
 
     fflush(stdout);
-    close(parent_pipe[0][0]);
-    close(parent_pipe[1][0]);
-    close(parent_pipe[2][0]);
-    close(parent_pipe[3][0]);
+    for(int i = 0; i < 4; i++){
+        if(parent_pipe[i][0] != -1){ // cached parts never opened a pipe, read ones are closed already
+            close(parent_pipe[i][0]);
+        }
+    }
 
     exit(EXIT_SUCCESS);
 }
\ No newline at end of file
@@ -0,0 +1,666 @@
+/**
+ * @file bench.c
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Throughput benchmark of vigenere.
+ *
+ * @details vigenere_bench [-s max_size] [-r repeats] [-t directory] [-b binary]
+ *          Generates synthetic corpora (line lengths, letter ratios, key lengths, sizes from 1 KiB up to max_size,
+ *          64 MiB by default, 10G for the large runs) and measures the throughput in GB/s of
+ *          - every kernel of libvigenere (generic, scalar, sse2, avx2, avx512) in memory,
+ *          - every I/O path of the binary (read, mmap, uring, pipeline, stdin, splice) and the threaded path (-j).
+ *          Every output is checked byte for byte against the reference, which is computed with vigenere_de_encryption one
+ *          character at a time, as the original implementation did. Cycles per byte are measured with perf_event_open
+ *          if the kernel allows it (user and kernel cycles of the benchmark and its children).
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/ioctl.h>
+
+#include "libvigenere_internal.h"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define PERF_COUNTERS
+#endif
+
+#define BLOCK_SIZE (1 << 20) // block size for generating and comparing files (1 MiB)
+#define MEMORY_LIMIT (64 << 20) // largest corpus benchmarked in memory (64 MiB)
+
+/**
+ * @struct profile
+ * @brief This structure represents a kind of synthetic text.
+ * @details line_length is the mean line length, letters the ratio of letters, others the ratio of bytes that are
+ *          neither letters nor special characters (translated by the constant stream of the vector kernels).
+ */
+typedef struct{
+    char *name;
+    size_t line_length;
+    double letters;
+    double others;
+} profile;
+
+/**
+ * @struct io_path
+ * @brief This structure represents an invocation of the binary.
+ * @details option is the --io option (or -j), stdin_input is 1 if the input is given on stdin, pipe_output is 1 if
+ *          stdout is a pipe drained by the benchmark (splice), 0 if the output goes to -o.
+ */
+typedef struct{
+    char *name;
+    char *option;
+    int stdin_input;
+    int pipe_output;
+} io_path;
+
+static const profile profiles[] = {
+    {"prose", 80, 0.80, 0.00},
+    {"log", 200, 0.50, 0.02},
+    {"short", 8, 0.60, 0.00},
+    {"long", 1 << 20, 0.95, 0.00}
+};
+
+static char *keys[] = {"K", "ARSLAN", "QWERTYUIOPASDFGH", "THEQUICKBROWNFOXJUMPSOVERTHELAZYDOGAGAIN"};
+
+static char *kernels[] = {"generic", "scalar", "sse2", "avx2", "avx512"};
+
+static const io_path io_paths[] = {
+    {"read", "--io=read", 0, 0},
+    {"mmap", "--io=mmap", 0, 0},
+    {"uring", "--io=uring", 0, 0},
+    {"pipeline", "--io=pipeline", 0, 0},
+    {"stdin", "--io=auto", 1, 0},
+    {"splice", "--io=splice", 1, 1},
+    {"threads", "-j", 0, 0}
+};
+
+static char *progname;
+static int cycles_fd = -1;
+
+/**
+* Usage function.
+* @brief Prints a message to stderr and stops the program with EXIT_FAILURE.
+*
+* @param error string
+*/
+static void usage(char *error){
+    fprintf(stderr, "%s: %s\n", progname, error);
+    exit(EXIT_FAILURE);
+}
+
+/**
+* Parsing a Size
+* @brief Parses a size with an optional K, M or G suffix.
+*
+* @param text size given on the command line
+* @return size in bytes
+*/
+static unsigned long long parse_size(char *text){
+    char *end;
+    unsigned long long size = strtoull(text, &end, 10);
+    if(*end == 'K' || *end == 'k'){
+        size <<= 10;
+        end++;
+    }
+    else if(*end == 'M' || *end == 'm'){
+        size <<= 20;
+        end++;
+    }
+    else if(*end == 'G' || *end == 'g'){
+        size <<= 30;
+        end++;
+    }
+    if(*end != '\0' || size == 0){
+        usage("a size needs the form N, NK, NM or NG.");
+    }
+    return size;
+}
+
+/**
+* Current Time
+* @brief Returns the monotonic time in seconds.
+*
+* @return seconds
+*/
+static double now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+* Opening the Cycle Counter
+* @brief Opens a CPU cycle counter of this process and its future children.
+* @details Kernel cycles are dropped if the perf_event_paranoid setting does not allow them. cycles_fd stays -1 if
+*          perf_event_open is not available.
+*/
+static void open_cycles(void){
+#ifdef PERF_COUNTERS
+    struct perf_event_attr attr;
+    for(int exclude_kernel = 0; exclude_kernel <= 1 && cycles_fd == -1; exclude_kernel++){
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        attr.inherit = 1;
+        attr.exclude_kernel = exclude_kernel;
+        attr.exclude_hv = 1;
+        cycles_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+}
+
+/**
+* Reading the Cycle Counter
+* @brief Returns the cycles counted so far (including exited children).
+*
+* @return cycles, 0 if there is no counter
+*/
+static uint64_t read_cycles(void){
+    uint64_t cycles = 0;
+    if(cycles_fd != -1 && read(cycles_fd, &cycles, sizeof(cycles)) != sizeof(cycles)){
+        cycles = 0;
+    }
+    return cycles;
+}
+
+/**
+* Random Numbers
+* @brief xorshift64 generator, so every corpus is the same on every run.
+*
+* @param state generator state
+* @return next random number
+*/
+static uint64_t next_random(uint64_t *state){
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+* Generating Text
+* @brief Fills a buffer with synthetic text of a profile.
+* @details The state of the generator and the current column are kept between calls, so a file can be generated
+*          block by block.
+*
+* @param text profile
+* @param buffer destination
+* @param length number of bytes
+* @param state generator state
+* @param column current column
+*/
+static void generate_text(const profile *text, char *buffer, size_t length, uint64_t *state, size_t *column){
+    static const char specials[] = " .,:-!=?%0123456789";
+    static const char others[] = "()[]{}<>/\\\"'#*+;_@";
+
+    for(size_t i = 0; i < length; i++){
+        uint64_t random = next_random(state);
+        double uniform = (random >> 11) * (1.0 / 9007199254740992.0);
+        if(++*column >= text->line_length && (random & 3) == 0){
+            buffer[i] = '\n';
+            *column = 0;
+        }
+        else if(uniform < text->letters){
+            buffer[i] = (char) ((random & 32 ? 'a' : 'A') + (random >> 8) % 26);
+        }
+        else if(uniform < text->letters + text->others){
+            buffer[i] = others[(random >> 8) % (sizeof(others) - 1)];
+        }
+        else{
+            buffer[i] = specials[(random >> 8) % (sizeof(specials) - 1)];
+        }
+    }
+}
+
+/**
+* Reference Encryption
+* @brief Encrypts a block one character at a time with vigenere_de_encryption, as the original implementation did.
+*
+* @param key uppercased key
+* @param in input bytes
+* @param out output bytes
+* @param length number of bytes
+* @param index key index of the first byte, advanced past the block
+*/
+static void reference_block(char *key, const char *in, char *out, size_t length, int *index){
+    int decrypt = -1;
+    int key_length = strlen(key);
+    for(size_t i = 0; i < length; i++){
+        if(vigenere_special_character(in[i]) == 1){
+            out[i] = in[i];
+        }
+        else{
+            out[i] = vigenere_de_encryption(&decrypt, key, in[i], *index, key_length);
+        }
+        *index = in[i] == '\n' ? 0 : *index + 1;
+    }
+}
+
+/**
+* Writing all Bytes
+* @brief Writes a whole buffer to a file descriptor.
+*
+* @param fd file descriptor
+* @param data bytes
+* @param length number of bytes
+*/
+static void write_all(int fd, const char *data, size_t length){
+    while(length > 0){
+        ssize_t result = write(fd, data, length);
+        if(result == -1 && errno == EINTR){
+            continue;
+        }
+        if(result <= 0){
+            usage("error occured while writing a corpus.");
+        }
+        data += result;
+        length -= result;
+    }
+}
+
+/**
+* Reading all Bytes
+* @brief Reads until the buffer is full or EOF is reached.
+*
+* @param fd file descriptor
+* @param data destination
+* @param length size of the buffer
+* @return number of bytes read
+*/
+static size_t read_all(int fd, char *data, size_t length){
+    size_t done = 0;
+    while(done < length){
+        ssize_t result = read(fd, data + done, length - done);
+        if(result == -1 && errno == EINTR){
+            continue;
+        }
+        if(result <= 0){
+            break;
+        }
+        done += result;
+    }
+    return done;
+}
+
+/**
+* Generating a Corpus
+* @brief Writes a corpus file and its reference encryption.
+*
+* @param text profile
+* @param key uppercased key
+* @param size size of the corpus
+* @param input path of the corpus
+* @param reference path of the reference output
+*/
+static void generate_corpus(const profile *text, char *key, unsigned long long size, char *input, char *reference){
+    char *plain = malloc(BLOCK_SIZE);
+    char *cipher = malloc(BLOCK_SIZE);
+    if(plain == NULL || cipher == NULL){
+        usage("error occured while allocating a block.");
+    }
+
+    int in = open(input, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    int out = open(reference, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if(in == -1 || out == -1){
+        usage("error occured while creating a corpus.");
+    }
+
+    uint64_t state = 0x9E3779B97F4A7C15ULL ^ size;
+    size_t column = 0;
+    int index = 0;
+    for(unsigned long long done = 0; done < size; ){
+        size_t length = size - done < BLOCK_SIZE ? size - done : BLOCK_SIZE;
+        generate_text(text, plain, length, &state, &column);
+        reference_block(key, plain, cipher, length, &index);
+        write_all(in, plain, length);
+        write_all(out, cipher, length);
+        done += length;
+    }
+
+    close(in);
+    close(out);
+    free(cipher);
+    free(plain);
+}
+
+/**
+* Comparing Files
+* @brief Checks whether two files are byte for byte the same.
+*
+* @param first path of the first file
+* @param second path of the second file
+* @return 1 if they are the same, 0 otherwise
+*/
+static int same_files(char *first, char *second){
+    char *a = malloc(BLOCK_SIZE);
+    char *b = malloc(BLOCK_SIZE);
+    int fa = open(first, O_RDONLY);
+    int fb = open(second, O_RDONLY);
+    int same = a != NULL && b != NULL && fa != -1 && fb != -1;
+
+    while(same){
+        size_t la = read_all(fa, a, BLOCK_SIZE);
+        size_t lb = read_all(fb, b, BLOCK_SIZE);
+        same = la == lb && memcmp(a, b, la) == 0;
+        if(la == 0){
+            break;
+        }
+    }
+
+    if(fa != -1){
+        close(fa);
+    }
+    if(fb != -1){
+        close(fb);
+    }
+    free(a);
+    free(b);
+    return same;
+}
+
+/**
+* Running the Binary
+* @brief Runs vigenere on a corpus with an I/O path and waits for it.
+*
+* @param binary path of vigenere
+* @param path I/O path
+* @param threads number of threads for the threaded path
+* @param key key
+* @param input path of the corpus
+* @param output path of the output
+* @return 0 if vigenere succeeded, -1 otherwise
+*/
+static int run_binary(char *binary, const io_path *path, char *threads, char *key, char *input, char *output){
+    int drain[2];
+    char *argv[8];
+    int argc = 0;
+
+    argv[argc++] = binary;
+    argv[argc++] = path->option;
+    if(strcmp(path->option, "-j") == 0){
+        argv[argc++] = threads;
+    }
+    if(!path->pipe_output){
+        argv[argc++] = "-o";
+        argv[argc++] = output;
+    }
+    argv[argc++] = key;
+    if(!path->stdin_input){
+        argv[argc++] = input;
+    }
+    argv[argc] = NULL;
+
+    unlink(output);
+    if(path->pipe_output && pipe(drain) == -1){
+        usage("error occured while creating a pipe.");
+    }
+
+    pid_t pid = fork();
+    if(pid == -1){
+        usage("error occured while forking.");
+    }
+    if(pid == 0){
+        if(path->stdin_input){
+            int fd = open(input, O_RDONLY);
+            if(fd == -1 || dup2(fd, STDIN_FILENO) == -1){
+                _exit(EXIT_FAILURE);
+            }
+        }
+        if(path->pipe_output){
+            close(drain[0]);
+            if(dup2(drain[1], STDOUT_FILENO) == -1){
+                _exit(EXIT_FAILURE);
+            }
+        }
+        execv(binary, argv);
+        _exit(EXIT_FAILURE);
+    }
+
+    if(path->pipe_output){
+        close(drain[1]);
+        int out = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        char *buffer = malloc(BLOCK_SIZE);
+        ssize_t length;
+        if(out == -1 || buffer == NULL){
+            usage("error occured while draining the output.");
+        }
+        while((length = read(drain[0], buffer, BLOCK_SIZE)) != 0){
+            if(length == -1 && errno == EINTR){
+                continue;
+            }
+            if(length == -1){
+                break;
+            }
+            write_all(out, buffer, length);
+        }
+        free(buffer);
+        close(out);
+        close(drain[0]);
+    }
+
+    int status;
+    while(waitpid(pid, &status, 0) == -1){
+        if(errno != EINTR){
+            return -1;
+        }
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+/**
+* Printing a Result
+* @brief Prints one line of results.
+*
+* @param group what was measured (kernel or I/O path)
+* @param text profile
+* @param key key
+* @param size size of the corpus
+* @param seconds best time
+* @param cycles cycles of the best run
+* @param correct 1 if the output matched the reference
+*/
+static void print_result(char *group, const profile *text, char *key, unsigned long long size, double seconds,
+                         uint64_t cycles, int correct){
+    printf("%-10s %-6s key %2zu %12llu B %9.3f GB/s", group, text->name, strlen(key), size, size / seconds / 1e9);
+    if(cycles_fd != -1){
+        printf(" %8.3f cycles/B", (double) cycles / size);
+    }
+    else{
+        printf(" %8s cycles/B", "n/a");
+    }
+    printf(" %s\n", correct ? "ok" : "MISMATCH");
+    fflush(stdout);
+}
+
+/**
+* Benchmarking the Kernels
+* @brief Measures every kernel supported by the CPU in memory, for every profile and key.
+*
+* @param size size of the corpus
+* @param repeats number of runs, the best one counts
+* @return number of mismatches
+*/
+static int bench_kernels(unsigned long long size, int repeats){
+    int mismatches = 0;
+    char *plain = malloc(size);
+    char *expected = malloc(size);
+    char *output = malloc(size);
+    if(plain == NULL || expected == NULL || output == NULL){
+        usage("error occured while allocating a corpus.");
+    }
+
+    for(size_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++){
+        uint64_t state = 0x9E3779B97F4A7C15ULL ^ size;
+        size_t column = 0;
+        generate_text(&profiles[p], plain, size, &state, &column);
+
+        for(size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++){
+            int index = 0;
+            reference_block(keys[k], plain, expected, size, &index);
+
+            for(size_t n = 0; n < sizeof(kernels) / sizeof(kernels[0]); n++){
+                vigenere_ctx ctx;
+                if(vigenere_init(&ctx, keys[k], 0, kernels[n]) != 0){
+                    continue;
+                }
+
+                double best = 0;
+                uint64_t best_cycles = 0;
+                for(int r = 0; r < repeats; r++){
+                    uint64_t cycles = read_cycles();
+                    double start = now();
+                    vigenere_update(&ctx, plain, output, size);
+                    double seconds = now() - start;
+                    cycles = read_cycles() - cycles;
+                    vigenere_final(&ctx, output);
+                    if(r == 0 || seconds < best){
+                        best = seconds;
+                        best_cycles = cycles;
+                    }
+                }
+
+                int correct = memcmp(output, expected, size) == 0;
+                mismatches += !correct;
+                print_result(kernels[n], &profiles[p], keys[k], size, best, best_cycles, correct);
+                vigenere_free(&ctx);
+            }
+        }
+    }
+
+    free(output);
+    free(expected);
+    free(plain);
+    return mismatches;
+}
+
+/**
+* Benchmarking the I/O Paths
+* @brief Measures every I/O path of the binary on a corpus file.
+*
+* @param binary path of vigenere
+* @param directory directory for the corpora
+* @param text profile
+* @param key key
+* @param size size of the corpus
+* @param repeats number of runs, the best one counts
+* @return number of mismatches
+*/
+static int bench_io(char *binary, char *directory, const profile *text, char *key, unsigned long long size, int repeats){
+    char input[4096];
+    char reference[4096];
+    char output[4096];
+    char threads[24];
+    int mismatches = 0;
+
+    snprintf(input, sizeof(input), "%s/corpus.%s.%llu", directory, text->name, size);
+    snprintf(reference, sizeof(reference), "%s/reference.%s.%llu", directory, text->name, size);
+    snprintf(output, sizeof(output), "%s/output.%s.%llu", directory, text->name, size);
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    snprintf(threads, sizeof(threads), "%ld", cpus > 1 ? cpus : 2);
+
+    generate_corpus(text, key, size, input, reference);
+
+    for(size_t i = 0; i < sizeof(io_paths) / sizeof(io_paths[0]); i++){
+        double best = 0;
+        uint64_t best_cycles = 0;
+        int failed = 0;
+        for(int r = 0; r < repeats && !failed; r++){
+            uint64_t cycles = read_cycles();
+            double start = now();
+            failed = run_binary(binary, &io_paths[i], threads, key, input, output) == -1;
+            double seconds = now() - start;
+            cycles = read_cycles() - cycles;
+            if(r == 0 || seconds < best){
+                best = seconds;
+                best_cycles = cycles;
+            }
+        }
+
+        int correct = !failed && same_files(output, reference);
+        mismatches += !correct;
+        print_result(io_paths[i].name, text, key, size, best, best_cycles, correct);
+    }
+
+    unlink(output);
+    unlink(reference);
+    unlink(input);
+    return mismatches;
+}
+
+/**
+ * main function
+ * @brief Entry point of the benchmark: kernels first, then the I/O paths for every size.
+ *
+ * @param argc number of arguments
+ * @param argv arguments
+ * @return EXIT_SUCCESS if every output matched, EXIT_FAILURE otherwise
+ */
+int main(int argc, char *argv[]){
+    unsigned long long max_size = MEMORY_LIMIT;
+    int repeats = 3;
+    char *directory = "/tmp";
+    char *binary = "./vigenere";
+    int option;
+
+    progname = argv[0];
+    while((option = getopt(argc, argv, "s:r:t:b:")) != -1){
+        switch(option){
+            case 's':
+                max_size = parse_size(optarg);
+                break;
+            case 'r':
+                repeats = atoi(optarg);
+                if(repeats < 1){
+                    usage("option -r needs a positive number of repeats.");
+                }
+                break;
+            case 't':
+                directory = optarg;
+                break;
+            case 'b':
+                binary = optarg;
+                break;
+            default:
+                usage("usage: vigenere_bench [-s max_size] [-r repeats] [-t directory] [-b binary]");
+        }
+    }
+    if(access(binary, X_OK) == -1){
+        usage("the vigenere binary was not found (-b binary).");
+    }
+
+    open_cycles();
+    int mismatches = 0;
+
+    printf("# kernels (in memory)\n");
+    mismatches += bench_kernels(max_size < MEMORY_LIMIT ? max_size : MEMORY_LIMIT, repeats);
+
+    printf("# I/O paths (%s)\n", binary);
+    for(unsigned long long size = 1 << 10; size <= max_size; size <<= 10){
+        mismatches += bench_io(binary, directory, &profiles[0], keys[1], size, repeats);
+    }
+    for(unsigned long long size = 64ULL << 20; size <= max_size; size <<= 4){
+        mismatches += bench_io(binary, directory, &profiles[1], keys[1], size, repeats);
+    }
+    if(max_size >= 10ULL << 30){
+        mismatches += bench_io(binary, directory, &profiles[0], keys[1], 10ULL << 30, 1);
+    }
+
+    if(mismatches > 0){
+        fprintf(stderr, "%s: %d outputs did not match the reference.\n", progname, mismatches);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,393 @@
+/**
+ * @file compress.c
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Compressed frames of vigenere (-z).
+ **/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+
+#include "vigenere.h"
+#include "compress.h"
+#include "output.h"
+#include "splice.h"
+#include "stats.h"
+
+#define COMPRESS_BLOCK_SIZE (256 << 10) // block (de)encrypted and (de)compressed at once by -z (256 KiB)
+#define COMPRESS_BOUND(length) ((length) + (length) / 255 + 16) // largest compressed size of a block
+#define COMPRESS_MAGIC "VGZ1" // magic of a frame of -z
+#define COMPRESS_MAGIC_SIZE (4)
+#define COMPRESS_HEADER_SIZE (8) // raw length and stored length of a block
+#define COMPRESS_STORED (0x80000000U) // flag of the stored length of a block that is not compressed
+#define COMPRESS_HASH_BITS (14) // size of the match finder hash table (16384 positions)
+#define COMPRESS_MIN_MATCH (4) // shortest match
+#define COMPRESS_MAX_OFFSET (65535) // farthest match
+#define COMPRESS_MATCH_LIMIT (12) // no match starts in the last 12 bytes of a block
+#define COMPRESS_LAST_LITERALS (5) // the last 5 bytes of a block are literals
+#define COMPRESS_SKIP_BITS (6) // misses before the match finder skips one more position
+
+/**
+* Storing a 32-bit Value
+* @brief Stores a value in little endian, the byte order of the -z format.
+*
+* @param out destination (4 bytes)
+* @param value value
+*/
+static void store_le32(unsigned char *out, uint32_t value){
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = value >> 24;
+}
+
+/**
+* Loading a 32-bit Value
+* @brief Loads a little endian value of the -z format.
+*
+* @param in source (4 bytes)
+* @return value
+*/
+static uint32_t load_le32(const unsigned char *in){
+    return in[0] | (uint32_t) in[1] << 8 | (uint32_t) in[2] << 16 | (uint32_t) in[3] << 24;
+}
+
+/**
+* Writing a Length
+* @brief Writes the remainder of a literal or match length (255, 255, ..., rest) of a compressed sequence.
+*
+* @param out destination
+* @param length remaining length (the 15 of the token already subtracted)
+* @return position after the length
+*/
+static unsigned char *compress_length(unsigned char *out, size_t length){
+    while(length >= 255){
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = (unsigned char) length;
+    return out;
+}
+
+/**
+* Writing a Sequence
+* @brief Writes literals and a match as one sequence of the LZ4 block format.
+* @details token (literal length << 4 | match length - 4), literal length rest, literals, offset (2 bytes little
+*          endian), match length rest. The last sequence of a block has literals only.
+*
+* @param out destination
+* @param literals literal bytes
+* @param literal_length number of literals
+* @param offset distance of the match, 0 for the last sequence
+* @param match_length length of the match (at least COMPRESS_MIN_MATCH)
+* @return position after the sequence
+*/
+static unsigned char *compress_sequence(unsigned char *out, const unsigned char *literals, size_t literal_length, size_t offset,
+                                 size_t match_length){
+    unsigned char *token = out++;
+    size_t match_code = offset == 0 ? 0 : match_length - COMPRESS_MIN_MATCH;
+
+    *token = (unsigned char) ((literal_length < 15 ? literal_length : 15) << 4 | (match_code < 15 ? match_code : 15));
+    if(literal_length >= 15){
+        out = compress_length(out, literal_length - 15);
+    }
+    memcpy(out, literals, literal_length);
+    out += literal_length;
+    if(offset == 0){
+        return out;
+    }
+    *out++ = offset & 0xFF;
+    *out++ = offset >> 8;
+    if(match_code >= 15){
+        out = compress_length(out, match_code - 15);
+    }
+    return out;
+}
+
+/**
+* Compressing a Block
+* @brief Compresses a block greedily into the LZ4 block format.
+* @details A hash table of 4-byte sequences gives one match candidate per position. Like LZ4, no match starts in the
+*          last COMPRESS_MATCH_LIMIT bytes and the last COMPRESS_LAST_LITERALS bytes are literals. Positions without a
+*          match are skipped faster and faster, so incompressible blocks cost little.
+*
+* @param in block
+* @param length size of the block (at most COMPRESS_BLOCK_SIZE)
+* @param out destination of at least COMPRESS_BOUND(length) bytes
+* @param hashes hash table of 1 << COMPRESS_HASH_BITS entries
+* @return size of the compressed block
+*/
+static size_t compress_block(const unsigned char *in, size_t length, unsigned char *out, uint32_t *hashes){
+    unsigned char *start = out;
+    size_t anchor = 0;
+
+    if(length > COMPRESS_MATCH_LIMIT){
+        size_t limit = length - COMPRESS_MATCH_LIMIT;
+        size_t misses = 0;
+        size_t i = 0;
+
+        memset(hashes, 0xFF, sizeof(uint32_t) << COMPRESS_HASH_BITS);
+        while(i < limit){
+            uint32_t sequence, candidate_sequence;
+            memcpy(&sequence, in + i, 4);
+            uint32_t hash = (sequence * 2654435761U) >> (32 - COMPRESS_HASH_BITS);
+            uint32_t candidate = hashes[hash];
+            hashes[hash] = i;
+
+            if(candidate == UINT32_MAX || i - candidate > COMPRESS_MAX_OFFSET
+               || (memcpy(&candidate_sequence, in + candidate, 4), candidate_sequence != sequence)){
+                i += 1 + (misses++ >> COMPRESS_SKIP_BITS);
+                continue;
+            }
+
+            while(i > anchor && candidate > 0 && in[i - 1] == in[candidate - 1]){
+                i--;
+                candidate--;
+            }
+            size_t match_length = COMPRESS_MIN_MATCH;
+            while(i + match_length < length - COMPRESS_LAST_LITERALS && in[i + match_length] == in[candidate + match_length]){
+                match_length++;
+            }
+
+            out = compress_sequence(out, in + anchor, i - anchor, i - candidate, match_length);
+            i += match_length;
+            anchor = i;
+            misses = 0;
+        }
+    }
+
+    out = compress_sequence(out, in + anchor, length - anchor, 0, 0);
+    return out - start;
+}
+
+/**
+* Reading a Length
+* @brief Reads the remainder of a literal or match length of a compressed sequence.
+*
+* @param in position of the remainder, advanced past it
+* @param end end of the compressed block
+* @param length length of the token, increased by the remainder
+* @return 0 on success, -1 if the block ends within the length
+*/
+static int decompress_length(const unsigned char **in, const unsigned char *end, size_t *length){
+    unsigned char byte;
+    do{
+        if(*in == end){
+            return -1;
+        }
+        byte = *(*in)++;
+        *length += byte;
+    } while(byte == 255);
+    return 0;
+}
+
+/**
+* Decompressing a Block
+* @brief Decompresses a block of the LZ4 block format, checking every length and offset.
+*
+* @param in compressed block
+* @param length size of the compressed block
+* @param out destination
+* @param capacity size of the destination
+* @return size of the decompressed block, -1 if the block is corrupt
+*/
+static ssize_t decompress_block(const unsigned char *in, size_t length, unsigned char *out, size_t capacity){
+    const unsigned char *end = in + length;
+    size_t done = 0;
+
+    while(in < end){
+        unsigned char token = *in++;
+        size_t literal_length = token >> 4;
+        if(literal_length == 15 && decompress_length(&in, end, &literal_length) == -1){
+            return -1;
+        }
+        if(literal_length > (size_t) (end - in) || literal_length > capacity - done){
+            return -1;
+        }
+        memcpy(out + done, in, literal_length);
+        in += literal_length;
+        done += literal_length;
+        if(in == end){
+            break;
+        }
+
+        if(end - in < 2){
+            return -1;
+        }
+        size_t offset = in[0] | (size_t) in[1] << 8;
+        in += 2;
+        size_t match_length = token & 15;
+        if(match_length == 15 && decompress_length(&in, end, &match_length) == -1){
+            return -1;
+        }
+        match_length += COMPRESS_MIN_MATCH;
+        if(offset == 0 || offset > done || match_length > capacity - done){
+            return -1;
+        }
+
+        unsigned char *match = out + done - offset;
+        if(offset >= match_length){
+            memcpy(out + done, match, match_length);
+        }
+        else{
+            for(size_t i = 0; i < match_length; i++){
+                out[done + i] = match[i];
+            }
+        }
+        done += match_length;
+    }
+    return done;
+}
+
+/**
+* Ciphering and Compressing
+* @brief (De)encrypts a stream and compresses it into one frame of the -z format.
+* @details Every block of COMPRESS_BLOCK_SIZE bytes is (de)encrypted in place and compressed right away, while it is
+*          still in the cache. A frame is COMPRESS_MAGIC, blocks of the form raw length (4 bytes), stored length
+*          (4 bytes, COMPRESS_STORED set if the block is not compressed) and the stored bytes, and a raw length of 0.
+*          Blocks are compressed independently.
+*
+* @param table cipher table of the key
+* @param fd input file descriptor
+* @param writer buffered output
+* @return 0 on success, -1 on a read error
+*/
+static int cipher_compress(vigenere_table *table, int fd, output_writer *writer){
+    unsigned char *buffer = malloc(COMPRESS_BLOCK_SIZE);
+    unsigned char *compressed = malloc(COMPRESS_BOUND(COMPRESS_BLOCK_SIZE) + COMPRESS_HEADER_SIZE);
+    uint32_t *hashes = malloc(sizeof(uint32_t) << COMPRESS_HASH_BITS);
+    if(buffer == NULL || compressed == NULL || hashes == NULL){
+        usage("./vigenere: error occured while allocating the compression buffers.");
+    }
+
+    write_output(writer, COMPRESS_MAGIC, COMPRESS_MAGIC_SIZE);
+    size_t index = 0;
+    ssize_t length;
+    while((length = fill_buffer(fd, (char *) buffer, COMPRESS_BLOCK_SIZE)) > 0){
+        index = stats_cipher(table, (char *) buffer, (char *) buffer, length, index);
+        size_t stored = compress_block(buffer, length, compressed + COMPRESS_HEADER_SIZE, hashes);
+
+        store_le32(compressed, length);
+        if(stored >= (size_t) length){
+            store_le32(compressed + 4, length | COMPRESS_STORED);
+            write_output(writer, (char *) compressed, COMPRESS_HEADER_SIZE);
+            write_output(writer, (char *) buffer, length);
+        }
+        else{
+            store_le32(compressed + 4, stored);
+            write_output(writer, (char *) compressed, COMPRESS_HEADER_SIZE + stored);
+        }
+    }
+
+    unsigned char end[4] = {0, 0, 0, 0};
+    write_output(writer, (char *) end, sizeof(end));
+
+    free(hashes);
+    free(compressed);
+    free(buffer);
+    return length == -1 ? -1 : 0;
+}
+
+/**
+* Decompressing and Ciphering
+* @brief Decompresses the frames of the -z format of a stream and (de)encrypts them.
+* @details Every block is decompressed and (de)encrypted in place while it is still in the cache. Concatenated frames
+*          are decompressed one after the other, the key index starts at 0 with every frame, as it does with every
+*          input file. A corrupt or truncated frame exits with EXIT_FAILURE.
+*
+* @param table cipher table of the key
+* @param fd input file descriptor
+* @param writer buffered output
+* @return 0 on success, -1 on a read error
+*/
+static int cipher_decompress(vigenere_table *table, int fd, output_writer *writer){
+    unsigned char *buffer = malloc(COMPRESS_BLOCK_SIZE);
+    unsigned char *compressed = malloc(COMPRESS_BOUND(COMPRESS_BLOCK_SIZE));
+    if(buffer == NULL || compressed == NULL){
+        usage("./vigenere: error occured while allocating the compression buffers.");
+    }
+
+    unsigned char header[COMPRESS_HEADER_SIZE];
+    ssize_t length;
+    while((length = fill_buffer(fd, (char *) header, COMPRESS_MAGIC_SIZE)) > 0){
+        if(length != COMPRESS_MAGIC_SIZE || memcmp(header, COMPRESS_MAGIC, COMPRESS_MAGIC_SIZE) != 0){
+            flush_output(writer);
+            usage("./vigenere: the input is not compressed with -z.");
+        }
+
+        size_t index = 0;
+        for(;;){
+            if(fill_buffer(fd, (char *) header, 4) != 4){
+                length = -2;
+                break;
+            }
+            uint32_t raw = load_le32(header);
+            if(raw == 0){
+                break;
+            }
+            if(fill_buffer(fd, (char *) header + 4, 4) != 4){
+                length = -2;
+                break;
+            }
+            uint32_t stored = load_le32(header + 4);
+            int is_stored = (stored & COMPRESS_STORED) != 0;
+            stored &= ~COMPRESS_STORED;
+            if(raw > COMPRESS_BLOCK_SIZE || stored > COMPRESS_BOUND(COMPRESS_BLOCK_SIZE) || (is_stored && stored != raw)){
+                length = -2;
+                break;
+            }
+
+            if(fill_buffer(fd, (char *) (is_stored ? buffer : compressed), stored) != (ssize_t) stored){
+                length = -2;
+                break;
+            }
+            if(!is_stored && decompress_block(compressed, stored, buffer, COMPRESS_BLOCK_SIZE) != (ssize_t) raw){
+                length = -2;
+                break;
+            }
+            index = stats_cipher(table, (char *) buffer, (char *) buffer, raw, index);
+            write_output(writer, (char *) buffer, raw);
+        }
+        if(length == -2){
+            flush_output(writer);
+            usage("./vigenere: the compressed input is corrupt or truncated.");
+        }
+    }
+
+    free(compressed);
+    free(buffer);
+    return length == -1 ? -1 : 0;
+}
+
+/**
+* Ciphering Compressed Text
+* @brief (De)encrypts and (de)compresses a file or stdin (-z).
+* @details Without -d every input becomes one compressed frame of the output, with -d the frames of every input are
+*          decompressed and decrypted.
+*
+* @param table cipher table of the key
+* @param file input file, NULL for stdin
+* @param decompress 1 if -d was given
+* @param writer buffered output
+*/
+void cipher_text_compressed(vigenere_table *table, char *file, int decompress, output_writer *writer){
+    int input = file == NULL ? STDIN_FILENO : open(file, O_RDONLY);
+    if(input == -1){
+        flush_output(writer);
+        usage("./viginere: Erorr occured while opening the input file.");
+    }
+
+    int result = decompress ? cipher_decompress(table, input, writer) : cipher_compress(table, input, writer);
+    if(result == -1){
+        flush_output(writer);
+        usage("./vigenere: error occured while reading the input file.");
+    }
+
+    if(file != NULL){
+        close(input);
+    }
+}
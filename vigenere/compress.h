@@ -0,0 +1,20 @@
+/**
+ * @file compress.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Compressed frames of vigenere (-z).
+ *
+ * @details Blocks are (de)encrypted and compressed with an LZ4-style compressor into frames, or decompressed and
+ *          (de)encrypted.
+ **/
+
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include "libvigenere_internal.h"
+#include "output.h"
+
+void cipher_text_compressed(vigenere_table *table, char *file, int decompress, output_writer *writer);
+
+#endif
@@ -0,0 +1,318 @@
+/**
+ * @file crack.c
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Cryptanalysis of vigenere (--crack).
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "vigenere.h"
+#include "crack.h"
+#include "mapped.h"
+#include "stats.h"
+
+#define CRACK_MAX_KEY_LENGTH (32) // longest key length tried by --crack
+#define CRACK_SAMPLE_SIZE (4 << 20) // bytes used by --crack to estimate the key length (4 MiB)
+#define CRACK_IOC_RATIO (0.9) // index of coincidence of a key length candidate, relative to the best one
+#define CRACK_NEWLINE (-1) // class of \n for --crack
+#define CRACK_OTHER (-2) // class of every other non-letter for --crack
+
+/**
+ * @struct crack_chunk
+ * @brief This structure represents a part of the ciphertext counted by one thread of --crack.
+ * @details data starts at a line start, so the key index of its first byte is 0. counts is a histogram of the letters
+ *          for every key position: counts[index * 26 + letter].
+ */
+typedef struct{
+    const unsigned char *data;
+    size_t length;
+    size_t key_length;
+    const signed char *classes;
+    uint64_t *counts;
+} crack_chunk;
+
+/**
+* Letter Classes
+* @brief Fills the class of every byte for the cryptanalysis.
+* @details Letters get their value 0-25 (case-insensitive), \n gets CRACK_NEWLINE and every other byte CRACK_OTHER, as it
+*          advances the key index like a letter.
+*
+* @param classes 256 classes to be filled
+*/
+static void crack_classes(signed char *classes){
+    for(int ch = 0; ch < 256; ch++){
+        int letter = vigenere_convert_char((char) ch);
+        classes[ch] = letter != -1 ? letter : ch == '\n' ? CRACK_NEWLINE : CRACK_OTHER;
+    }
+}
+
+/**
+* Estimating the Key Length
+* @brief Estimates the key length from the index of coincidence and a Kasiski examination.
+* @details For every key length up to CRACK_MAX_KEY_LENGTH the letters are split by key position and the mean index
+*          of coincidence of the columns is computed. Every length whose index is at least CRACK_IOC_RATIO of the best
+*          one is a candidate (the key length and its multiples). Among them, the length dividing the most distances
+*          between repeated trigrams of a line (Kasiski) wins, ties go to the shorter length.
+*
+* @param data ciphertext
+* @param length number of bytes (a sample of the ciphertext)
+* @param classes letter classes
+* @return estimated key length
+*/
+static size_t crack_key_length(const unsigned char *data, size_t length, const signed char *classes){
+    size_t bases[CRACK_MAX_KEY_LENGTH + 1];
+    size_t indices[CRACK_MAX_KEY_LENGTH + 1];
+    uint64_t votes[CRACK_MAX_KEY_LENGTH + 1];
+    double coincidence[CRACK_MAX_KEY_LENGTH + 1];
+
+    size_t total = 0;
+    for(size_t l = 1; l <= CRACK_MAX_KEY_LENGTH; l++){
+        bases[l] = total;
+        indices[l] = 0;
+        votes[l] = 0;
+        total += l * 26;
+    }
+
+    uint32_t *counts = calloc(total, sizeof(uint32_t));
+    uint64_t *trigram_line = calloc(26 * 26 * 26, sizeof(uint64_t));
+    uint64_t *trigram_column = malloc(26 * 26 * 26 * sizeof(uint64_t));
+    if(counts == NULL || trigram_line == NULL || trigram_column == NULL){
+        usage("./vigenere: error occured while allocating the histograms.");
+    }
+
+    uint64_t line = 1;
+    uint64_t column = 0;
+    int run = 0;
+    int trigram = 0;
+
+    for(size_t i = 0; i < length; i++){
+        int letter = classes[data[i]];
+        if(letter == CRACK_NEWLINE){
+            for(size_t l = 1; l <= CRACK_MAX_KEY_LENGTH; l++){
+                indices[l] = 0;
+            }
+            line++;
+            column = 0;
+            run = 0;
+            continue;
+        }
+
+        if(letter >= 0){
+            for(size_t l = 1; l <= CRACK_MAX_KEY_LENGTH; l++){
+                counts[bases[l] + indices[l] * 26 + letter]++;
+            }
+
+            trigram = (trigram * 26 + letter) % (26 * 26 * 26);
+            if(++run >= 3){
+                uint64_t start = column - 2;
+                if(trigram_line[trigram] == line){
+                    uint64_t distance = start - trigram_column[trigram];
+                    for(size_t l = 1; l <= CRACK_MAX_KEY_LENGTH; l++){
+                        votes[l] += distance % l == 0;
+                    }
+                }
+                trigram_line[trigram] = line;
+                trigram_column[trigram] = start;
+            }
+        }
+        else{
+            run = 0;
+        }
+
+        for(size_t l = 1; l <= CRACK_MAX_KEY_LENGTH; l++){
+            if(++indices[l] == l){
+                indices[l] = 0;
+            }
+        }
+        column++;
+    }
+
+    double best = 0;
+    for(size_t l = 1; l <= CRACK_MAX_KEY_LENGTH; l++){
+        double sum = 0;
+        for(size_t index = 0; index < l; index++){
+            const uint32_t *histogram = counts + bases[l] + index * 26;
+            uint64_t letters = 0;
+            uint64_t pairs = 0;
+            for(int letter = 0; letter < 26; letter++){
+                letters += histogram[letter];
+                pairs += (uint64_t) histogram[letter] * (histogram[letter] - (histogram[letter] > 0));
+            }
+            sum += letters > 1 ? (double) pairs / ((double) letters * (letters - 1)) : 0;
+        }
+        coincidence[l] = sum / l;
+        if(coincidence[l] > best){
+            best = coincidence[l];
+        }
+    }
+
+    size_t key_length = 1;
+    for(size_t l = 1; l <= CRACK_MAX_KEY_LENGTH; l++){
+        if(coincidence[l] >= CRACK_IOC_RATIO * best
+           && (coincidence[key_length] < CRACK_IOC_RATIO * best || votes[l] > votes[key_length])){
+            key_length = l;
+        }
+    }
+
+    free(trigram_column);
+    free(trigram_line);
+    free(counts);
+    return key_length;
+}
+
+/**
+* Counting Thread
+* @brief Counts the letters of a chunk for every key position.
+*
+* @param argument crack_chunk
+* @return NULL
+*/
+static void *crack_count_thread(void *argument){
+    crack_chunk *chunk = argument;
+    size_t index = 0;
+
+    for(size_t i = 0; i < chunk->length; i++){
+        int letter = chunk->classes[chunk->data[i]];
+        if(letter >= 0){
+            chunk->counts[index * 26 + letter]++;
+        }
+        if(letter == CRACK_NEWLINE || ++index == chunk->key_length){
+            index = 0;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+* Recovering a Key Letter
+* @brief Finds the shift of one key position with a chi-squared test against English letter frequencies.
+*
+* @param counts letter histogram of the key position
+* @return key letter
+*/
+static char crack_key_letter(const uint64_t *counts){
+    static const double english[26] = {
+        8.167, 1.492, 2.782, 4.253, 12.702, 2.228, 2.015, 6.094, 6.966, 0.153, 0.772, 4.025, 2.406,
+        6.749, 7.507, 1.929, 0.095, 5.987, 6.327, 9.056, 2.758, 0.978, 2.360, 0.150, 1.974, 0.074
+    };
+
+    uint64_t letters = 0;
+    for(int letter = 0; letter < 26; letter++){
+        letters += counts[letter];
+    }
+    if(letters == 0){
+        return 'A';
+    }
+
+    int best_shift = 0;
+    double best = -1;
+    for(int shift = 0; shift < 26; shift++){
+        double chi = 0;
+        for(int letter = 0; letter < 26; letter++){
+            double expected = letters * english[letter] / 100;
+            double difference = counts[(letter + shift) % 26] - expected;
+            chi += difference * difference / expected;
+        }
+        if(best < 0 || chi < best){
+            best = chi;
+            best_shift = shift;
+        }
+    }
+    return (char) ('A' + best_shift);
+}
+
+/**
+* Cracking a Key
+* @brief Recovers the key of an encrypted file and prints it to stdout.
+* @details The key length is estimated on the first CRACK_SAMPLE_SIZE bytes (crack_key_length). The whole file is then
+*          split between the threads at line starts, every thread counts the letters of its chunk per key position and
+*          the histograms are merged, so the chi-squared test of every key letter sees all of the ciphertext.
+*          The ciphertext is assumed to be English text encrypted with vigenere (not -d).
+*
+* @param file encrypted file
+* @param threads number of threads
+*/
+void crack_key(char *file, int threads){
+    struct stat st;
+    void *mapping;
+    size_t mapped_length;
+    signed char classes[256];
+
+    int fd = open(file, O_RDONLY);
+    if(fd == -1){
+        usage("./viginere: Erorr occured while opening the input file.");
+    }
+    if(fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) || st.st_size == 0){
+        usage("./vigenere: option --crack needs a non-empty regular input file.");
+    }
+
+    const unsigned char *data = (const unsigned char *) map_window(fd, 0, st.st_size, PROT_READ, &mapping, &mapped_length);
+    if(data == NULL){
+        usage("./vigenere: error occured while mapping the input file.");
+    }
+    madvise(mapping, mapped_length, MADV_SEQUENTIAL);
+    if(stats_mode != STATS_OFF){
+        stats_thread()->mapped_in += st.st_size;
+    }
+
+    crack_classes(classes);
+    size_t size = st.st_size;
+    size_t key_length = crack_key_length(data, size < CRACK_SAMPLE_SIZE ? size : CRACK_SAMPLE_SIZE, classes);
+
+    crack_chunk chunks[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+    size_t start = 0;
+    for(int t = 0; t < threads; t++){
+        size_t end = t == threads - 1 ? size : size / threads * (t + 1);
+        if(end < start){
+            end = start;
+        }
+        const unsigned char *newline = end < size ? memchr(data + end, '\n', size - end) : NULL;
+        if(t < threads - 1){
+            end = newline == NULL ? size : (size_t) (newline - data) + 1;
+        }
+
+        chunks[t].data = data + start;
+        chunks[t].length = end - start;
+        chunks[t].key_length = key_length;
+        chunks[t].classes = classes;
+        chunks[t].counts = calloc(key_length * 26, sizeof(uint64_t));
+        if(chunks[t].counts == NULL){
+            usage("./vigenere: error occured while allocating the histograms.");
+        }
+        if(pthread_create(&ids[t], NULL, crack_count_thread, &chunks[t]) != 0){
+            usage("./vigenere: error occured while creating a thread.");
+        }
+        start = end;
+    }
+
+    for(int t = 0; t < threads; t++){
+        pthread_join(ids[t], NULL);
+        if(t > 0){
+            for(size_t i = 0; i < key_length * 26; i++){
+                chunks[0].counts[i] += chunks[t].counts[i];
+            }
+            free(chunks[t].counts);
+        }
+    }
+
+    for(size_t index = 0; index < key_length; index++){
+        putchar(crack_key_letter(chunks[0].counts + index * 26));
+    }
+    putchar('\n');
+
+    free(chunks[0].counts);
+    munmap(mapping, mapped_length);
+    close(fd);
+}
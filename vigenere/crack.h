@@ -0,0 +1,17 @@
+/**
+ * @file crack.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Cryptanalysis of vigenere (--crack).
+ *
+ * @details Estimates the key length of a ciphertext with the index of coincidence and every key letter with a
+ *          chi-squared test against English letter frequencies.
+ **/
+
+#ifndef CRACK_H
+#define CRACK_H
+
+void crack_key(char *file, int threads);
+
+#endif
@@ -0,0 +1,617 @@
+/**
+ * @file daemon.c
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief (De)Encryption daemon of vigenere (--daemon).
+ **/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "vigenere.h"
+#include "daemon.h"
+#include "stats.h"
+
+#define DAEMON_MAX_CONNECTIONS (1024) // maximal number of open connections of --daemon
+#define DAEMON_BUFFER_SIZE (64 << 10) // receive buffer of a daemon connection, also the longest request line (64 KiB)
+#define DAEMON_CACHE_KEYS (256) // number of cipher tables cached by --daemon
+#define DAEMON_MAX_PENDING (16 << 20) // largest buffered response of a daemon connection (16 MiB)
+#define DAEMON_SERVE_ROUNDS (16) // read/write rounds of a daemon connection before it is handed back
+
+/**
+ * @struct daemon_connection
+ * @brief This structure represents a client connection of the daemon.
+ * @details The socket is non-blocking, a connection is only served while it can make progress.
+ *          buffer holds used received bytes from start on that are not processed yet (possibly the next request).
+ *          output holds output_used (de)encrypted bytes from output_start on that are not written yet, it grows up to
+ *          DAEMON_MAX_PENDING bytes. table is the table of the current request (NULL between requests), private_table
+ *          its storage if the cache is full, remaining the body bytes of the request not received yet and index the
+ *          key index of the next one. eof is set once nothing more is read (the client closed its side or sent an
+ *          invalid request), the connection is closed when the buffered requests are answered. events are the poll events
+ *          the connection waits for while it is idle.
+ */
+typedef struct{
+    int fd;
+    char *buffer;
+    size_t start;
+    size_t used;
+    char *output;
+    size_t output_start;
+    size_t output_used;
+    size_t output_size;
+    vigenere_table *table;
+    vigenere_table private_table;
+    int private;
+    unsigned long long remaining;
+    size_t index;
+    int eof;
+    short events;
+} daemon_connection;
+
+/**
+ * @struct daemon_key
+ * @brief This structure represents a cached cipher table of the daemon.
+ */
+typedef struct{
+    char *key;
+    int decrypt;
+    vigenere_table table;
+} daemon_key;
+
+/**
+ * @struct daemon_server
+ * @brief This structure represents the state shared by the event loop and the workers of the daemon.
+ * @details The event loop polls the idle connections. A connection that is ready is moved to queue and served by a
+ *          worker, which hands it back through returned and a byte on the wake pipe. Workers never block on a client.
+ *          connections counts all open connections. cache holds the tables of up to DAEMON_CACHE_KEYS keys, entries
+ *          are never replaced, so a worker can use a table without holding the lock.
+ */
+typedef struct{
+    int listener;
+    int wake[2];
+    int stop;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    daemon_connection *queue[DAEMON_MAX_CONNECTIONS];
+    size_t queue_head;
+    size_t queue_count;
+    daemon_connection *returned[DAEMON_MAX_CONNECTIONS];
+    size_t returned_count;
+    size_t connections;
+    pthread_mutex_t cache_lock;
+    daemon_key cache[DAEMON_CACHE_KEYS];
+    size_t cached;
+} daemon_server;
+
+static volatile sig_atomic_t daemon_quit = 0;
+
+/**
+* Daemon Signal Handler
+* @brief Sets daemon_quit on SIGINT or SIGTERM.
+*
+* @param signal signal
+*/
+static void handle_daemon_signal(int signal){
+    daemon_quit = 1;
+}
+
+/**
+* Reserving Output
+* @brief Makes room for length more bytes in the output of a connection.
+* @details The written bytes are dropped from the front first, then the buffer is doubled, up to DAEMON_MAX_PENDING.
+*
+* @param connection client
+* @param length number of bytes
+* @return number of bytes that fit after output_used, at most length
+*/
+static size_t daemon_reserve(daemon_connection *connection, size_t length){
+    if(connection->output_start > 0){
+        memmove(connection->output, connection->output + connection->output_start, connection->output_used);
+        connection->output_start = 0;
+    }
+    size_t size = connection->output_size;
+    while(size - connection->output_used < length && size < DAEMON_MAX_PENDING){
+        size *= 2;
+    }
+    if(size != connection->output_size){
+        char *output = realloc(connection->output, size);
+        if(output != NULL){
+            connection->output = output;
+            connection->output_size = size;
+        }
+    }
+    size_t free_bytes = connection->output_size - connection->output_used;
+    return free_bytes < length ? free_bytes : length;
+}
+
+/**
+* Answering with an Error
+* @brief Queues "ERROR reason\n" and stops reading requests of a connection.
+* @details The unprocessed bytes are dropped, the connection is closed once the error is written.
+*
+* @param connection client
+* @param message error line
+*/
+static void daemon_error(daemon_connection *connection, const char *message){
+    size_t length = strlen(message);
+    if(daemon_reserve(connection, length) == length){
+        memcpy(connection->output + connection->output_used, message, length);
+        connection->output_used += length;
+    }
+    connection->used = 0;
+    connection->eof = 1;
+}
+
+/**
+* Looking up a Key
+* @brief Returns the cipher table of a key from the cache, building and caching it if needed.
+* @details If the cache is full, a private table is built into table and *private is set, the caller frees it.
+*
+* @param server daemon
+* @param key uppercased key
+* @param decrypt decrypt flag (1 for present, -1 otherwise)
+* @param table storage for a private table
+* @param private set to 1 if table was used
+* @return cipher table, NULL on an allocation error
+*/
+static vigenere_table *daemon_table(daemon_server *server, char *key, int decrypt, vigenere_table *table, int *private){
+    *private = 0;
+    pthread_mutex_lock(&server->cache_lock);
+    for(size_t i = 0; i < server->cached; i++){
+        if(server->cache[i].decrypt == decrypt && strcmp(server->cache[i].key, key) == 0){
+            pthread_mutex_unlock(&server->cache_lock);
+            return &server->cache[i].table;
+        }
+    }
+
+    if(server->cached == DAEMON_CACHE_KEYS){
+        pthread_mutex_unlock(&server->cache_lock);
+        *private = 1;
+        return vigenere_build_table(table, key, strlen(key), &decrypt, getenv(KERNEL_ENV)) == 0 ? table : NULL;
+    }
+
+    daemon_key *entry = &server->cache[server->cached];
+    entry->key = strdup(key);
+    entry->decrypt = decrypt;
+    if(entry->key == NULL || vigenere_build_table(&entry->table, key, strlen(key), &decrypt, getenv(KERNEL_ENV)) != 0){
+        free(entry->key);
+        pthread_mutex_unlock(&server->cache_lock);
+        return NULL;
+    }
+    server->cached++;
+    pthread_mutex_unlock(&server->cache_lock);
+    return &entry->table;
+}
+
+/**
+* Starting a Request
+* @brief Parses a buffered request line of a client and looks up the table of its key.
+* @details A request is a line "E KEY LENGTH\n" (encrypt) or "D KEY LENGTH\n" (decrypt) followed by LENGTH bytes.
+*          An invalid request is answered with daemon_error.
+*
+* @param server daemon
+* @param connection client
+* @return 1 if a request line was consumed, 0 if it is not complete yet
+*/
+static int daemon_start_request(daemon_server *server, daemon_connection *connection){
+    char *newline = memchr(connection->buffer + connection->start, '\n', connection->used);
+    if(newline == NULL){
+        if(connection->used == DAEMON_BUFFER_SIZE){
+            daemon_error(connection, "ERROR request line too long\n");
+            return 1;
+        }
+        return 0;
+    }
+
+    char *line = connection->buffer + connection->start;
+    size_t line_length = newline - line + 1;
+    *newline = '\0';
+    connection->start += line_length;
+    connection->used -= line_length;
+
+    if(line_length < 3 || (line[0] != 'E' && line[0] != 'D') || line[1] != ' '){
+        daemon_error(connection, "ERROR malformed request\n");
+        return 1;
+    }
+    char *key = line + 2;
+    char *space = memchr(key, ' ', line_length - 3); // the space before LENGTH, searched only within the line
+    char *end;
+    if(space == NULL || space == key || !isdigit((unsigned char) space[1])){
+        daemon_error(connection, "ERROR malformed request\n");
+        return 1;
+    }
+    *space = '\0';
+    unsigned long long remaining = strtoull(space + 1, &end, 10);
+    if(*end != '\0'){
+        daemon_error(connection, "ERROR malformed request\n");
+        return 1;
+    }
+    for(char *c = key; *c != '\0'; c++){
+        if(vigenere_convert_char(*c) == -1){
+            daemon_error(connection, "ERROR invalid key\n");
+            return 1;
+        }
+        *c = toupper(*c);
+    }
+
+    connection->table = daemon_table(server, key, line[0] == 'D' ? 1 : -1, &connection->private_table, &connection->private);
+    if(connection->table == NULL){
+        daemon_error(connection, "ERROR out of memory\n");
+        return 1;
+    }
+    connection->remaining = remaining;
+    connection->index = 0;
+    return 1;
+}
+
+/**
+* Ending a Request
+* @brief Releases the table of the current request of a client.
+*
+* @param connection client
+*/
+static void daemon_end_request(daemon_connection *connection){
+    if(connection->private){
+        vigenere_free_table(&connection->private_table);
+        connection->private = 0;
+    }
+    connection->table = NULL;
+}
+
+/**
+* Processing Received Bytes
+* @brief Parses the buffered requests of a client and (de)encrypts their bodies into its output.
+* @details Stops when the buffered bytes are used up or the output holds DAEMON_MAX_PENDING bytes.
+*
+* @param server daemon
+* @param connection client
+*/
+static void daemon_process(daemon_server *server, daemon_connection *connection){
+    while(connection->used > 0 || (connection->table != NULL && connection->remaining == 0)){
+        if(connection->table == NULL){
+            if(!daemon_start_request(server, connection)){
+                return;
+            }
+            continue;
+        }
+        if(connection->remaining == 0){
+            daemon_end_request(connection);
+            continue;
+        }
+
+        size_t chunk = connection->used < connection->remaining ? connection->used : (size_t) connection->remaining;
+        chunk = daemon_reserve(connection, chunk);
+        if(chunk == 0){
+            return;
+        }
+        char *data = connection->buffer + connection->start;
+        connection->index = stats_cipher(connection->table, data, connection->output + connection->output_used, chunk,
+                                         connection->index);
+        connection->output_used += chunk;
+        connection->start += chunk;
+        connection->used -= chunk;
+        connection->remaining -= chunk;
+    }
+}
+
+/**
+* Serving a Connection
+* @brief Reads, (de)encrypts and writes the bytes of a client as far as its socket allows without blocking.
+* @details Requests can follow each other on a connection, the response of a request are its LENGTH (de)encrypted
+*          bytes. The body is (de)encrypted as it arrives, the response is buffered up to DAEMON_MAX_PENDING bytes,
+*          so a client can send a whole body of that size before reading. Beyond that, no more bytes are read until
+*          the client reads. After DAEMON_SERVE_ROUNDS rounds the connection is handed back, so a fast client cannot
+*          keep a worker from the others. On return, events holds the poll events the connection waits for.
+*
+* @param server daemon
+* @param connection client
+* @return 1 if the connection can be kept, 0 if it has to be closed
+*/
+static int daemon_serve(daemon_server *server, daemon_connection *connection){
+    for(int round = 0; round < DAEMON_SERVE_ROUNDS; round++){
+        int progress = 0;
+        daemon_process(server, connection);
+
+        if(connection->output_used > 0){
+            ssize_t result = stats_write(connection->fd, connection->output + connection->output_start, connection->output_used);
+            if(result > 0){
+                connection->output_start += result;
+                connection->output_used -= result;
+                progress = 1;
+            }
+            else if(result == -1 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR){
+                return 0;
+            }
+        }
+
+        if(!connection->eof && connection->output_used < DAEMON_MAX_PENDING){
+            if(connection->start > 0){
+                memmove(connection->buffer, connection->buffer + connection->start, connection->used);
+                connection->start = 0;
+            }
+            if(connection->used < DAEMON_BUFFER_SIZE){
+                ssize_t result = stats_read(connection->fd, connection->buffer + connection->used,
+                                            DAEMON_BUFFER_SIZE - connection->used);
+                if(result > 0){
+                    connection->used += result;
+                    progress = 1;
+                }
+                else if(result == 0){
+                    connection->eof = 1;
+                    progress = 1;
+                }
+                else if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR){
+                    return 0;
+                }
+            }
+        }
+
+        if(!progress){
+            break;
+        }
+    }
+
+    daemon_process(server, connection);
+    if(connection->eof && connection->output_used == 0){
+        return 0;
+    }
+    connection->events = 0;
+    if(connection->output_used > 0){
+        connection->events |= POLLOUT;
+    }
+    if(!connection->eof && connection->output_used < DAEMON_MAX_PENDING){
+        connection->events |= POLLIN;
+    }
+    return 1;
+}
+
+/**
+* Closing a Connection
+* @brief Closes the socket of a client and frees its buffers and its private table.
+*
+* @param connection client
+*/
+static void daemon_close(daemon_connection *connection){
+    daemon_end_request(connection);
+    close(connection->fd);
+    free(connection->output);
+    free(connection->buffer);
+    free(connection);
+}
+
+/**
+* Daemon Worker Thread
+* @brief Serves the queued connections (daemon_serve) and hands them back to the event loop.
+*
+* @param argument daemon_server
+* @return NULL
+*/
+static void *daemon_worker_thread(void *argument){
+    daemon_server *server = argument;
+
+    while(1){
+        pthread_mutex_lock(&server->lock);
+        while(server->queue_count == 0 && !server->stop){
+            pthread_cond_wait(&server->work, &server->lock);
+        }
+        if(server->stop){
+            pthread_mutex_unlock(&server->lock);
+            return NULL;
+        }
+        daemon_connection *connection = server->queue[server->queue_head];
+        server->queue_head = (server->queue_head + 1) % DAEMON_MAX_CONNECTIONS;
+        server->queue_count--;
+        pthread_mutex_unlock(&server->lock);
+
+        int keep = daemon_serve(server, connection);
+
+        pthread_mutex_lock(&server->lock);
+        if(keep){
+            server->returned[server->returned_count++] = connection;
+        }
+        else{
+            server->connections--;
+        }
+        pthread_mutex_unlock(&server->lock);
+
+        if(!keep){
+            daemon_close(connection);
+        }
+        while(write(server->wake[1], "", 1) == -1 && errno == EINTR);
+    }
+}
+
+/**
+* Running the Daemon
+* @brief Serves (de)encryption requests on a Unix domain socket until SIGINT or SIGTERM.
+* @details The calling thread runs the event loop (poll over the listener, the wake pipe and the idle connections),
+*          threads workers serve the connections that are ready (daemon_serve). The sockets are non-blocking, so a
+*          client that stalls only waits in the poll set. Cipher tables are cached per key and direction.
+*
+* @param path path of the socket
+* @param threads number of worker threads
+*/
+void run_daemon(char *path, int threads){
+    daemon_server server;
+    struct sockaddr_un address;
+    struct pollfd fds[DAEMON_MAX_CONNECTIONS + 2];
+    daemon_connection *connections[DAEMON_MAX_CONNECTIONS + 2];
+    pthread_t ids[MAX_THREADS];
+
+    if(strlen(path) >= sizeof(address.sun_path)){
+        usage("./vigenere: the socket path is too long.");
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_daemon_signal;
+    if(sigaction(SIGINT, &sa, NULL) == -1 || sigaction(SIGTERM, &sa, NULL) == -1){
+        usage("./vigenere: failed on sigaction.");
+    }
+    sa.sa_handler = SIG_IGN;
+    if(sigaction(SIGPIPE, &sa, NULL) == -1){
+        usage("./vigenere: failed on sigaction.");
+    }
+
+    server.listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(server.listener == -1){
+        usage("./vigenere: error occured while creating the socket.");
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    unlink(path);
+    if(bind(server.listener, (struct sockaddr *) &address, sizeof(address)) == -1 || listen(server.listener, SOMAXCONN) == -1){
+        usage("./vigenere: error occured while binding the socket.");
+    }
+    if(pipe(server.wake) == -1){
+        usage("./vigenere: error occured while creating the wake pipe.");
+    }
+
+    server.stop = 0;
+    server.queue_head = 0;
+    server.queue_count = 0;
+    server.returned_count = 0;
+    server.connections = 0;
+    server.cached = 0;
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.work, NULL);
+    pthread_mutex_init(&server.cache_lock, NULL);
+
+    for(int i = 0; i < threads; i++){
+        if(pthread_create(&ids[i], NULL, daemon_worker_thread, &server) != 0){
+            usage("./vigenere: error occured while creating a thread.");
+        }
+    }
+
+    fds[0].fd = server.listener;
+    fds[0].events = POLLIN;
+    fds[1].fd = server.wake[0];
+    fds[1].events = POLLIN;
+    nfds_t count = 2;
+
+    while(!daemon_quit){
+        if(poll(fds, count, -1) == -1){
+            if(errno == EINTR){
+                continue;
+            }
+            usage("./vigenere: error occured while polling.");
+        }
+
+        for(nfds_t i = 2; i < count; i++){
+            if(fds[i].revents == 0){
+                continue;
+            }
+            pthread_mutex_lock(&server.lock);
+            server.queue[(server.queue_head + server.queue_count) % DAEMON_MAX_CONNECTIONS] = connections[i];
+            server.queue_count++;
+            pthread_cond_signal(&server.work);
+            pthread_mutex_unlock(&server.lock);
+
+            count--;
+            fds[i] = fds[count];
+            connections[i] = connections[count];
+            i--;
+        }
+
+        if(fds[1].revents != 0){
+            char drain[64];
+            while(read(server.wake[0], drain, sizeof(drain)) == -1 && errno == EINTR);
+            pthread_mutex_lock(&server.lock);
+            for(size_t i = 0; i < server.returned_count; i++){
+                fds[count].fd = server.returned[i]->fd;
+                fds[count].events = server.returned[i]->events;
+                fds[count].revents = 0;
+                connections[count++] = server.returned[i];
+            }
+            server.returned_count = 0;
+            pthread_mutex_unlock(&server.lock);
+        }
+
+        if(fds[0].revents != 0){
+            int fd = accept(server.listener, NULL, NULL);
+            if(fd == -1){
+                continue;
+            }
+            pthread_mutex_lock(&server.lock);
+            int full = server.connections == DAEMON_MAX_CONNECTIONS;
+            server.connections += !full;
+            pthread_mutex_unlock(&server.lock);
+
+            daemon_connection *connection = malloc(sizeof(daemon_connection));
+            char *buffer = malloc(DAEMON_BUFFER_SIZE);
+            char *output = malloc(DAEMON_BUFFER_SIZE);
+            int flags = fcntl(fd, F_GETFL);
+            if(connection == NULL || buffer == NULL || output == NULL || full || flags == -1
+               || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1){
+                free(connection);
+                free(buffer);
+                free(output);
+                close(fd);
+                if(!full){
+                    pthread_mutex_lock(&server.lock);
+                    server.connections--;
+                    pthread_mutex_unlock(&server.lock);
+                }
+                continue;
+            }
+            connection->fd = fd;
+            connection->buffer = buffer;
+            connection->start = 0;
+            connection->used = 0;
+            connection->output = output;
+            connection->output_start = 0;
+            connection->output_used = 0;
+            connection->output_size = DAEMON_BUFFER_SIZE;
+            connection->table = NULL;
+            connection->private = 0;
+            connection->remaining = 0;
+            connection->index = 0;
+            connection->eof = 0;
+            connection->events = POLLIN;
+            fds[count].fd = fd;
+            fds[count].events = POLLIN;
+            fds[count].revents = 0;
+            connections[count++] = connection;
+        }
+    }
+
+    pthread_mutex_lock(&server.lock);
+    server.stop = 1;
+    pthread_cond_broadcast(&server.work);
+    pthread_mutex_unlock(&server.lock);
+    for(int i = 0; i < threads; i++){
+        pthread_join(ids[i], NULL);
+    }
+
+    for(size_t i = 0; i < server.queue_count; i++){
+        daemon_close(server.queue[(server.queue_head + i) % DAEMON_MAX_CONNECTIONS]);
+    }
+    for(nfds_t i = 2; i < count; i++){
+        daemon_close(connections[i]);
+    }
+    for(size_t i = 0; i < server.returned_count; i++){
+        daemon_close(server.returned[i]);
+    }
+    for(size_t i = 0; i < server.cached; i++){
+        free(server.cache[i].key);
+        vigenere_free_table(&server.cache[i].table);
+    }
+    pthread_mutex_destroy(&server.lock);
+    pthread_cond_destroy(&server.work);
+    pthread_mutex_destroy(&server.cache_lock);
+    close(server.wake[0]);
+    close(server.wake[1]);
+    close(server.listener);
+    unlink(path);
+}
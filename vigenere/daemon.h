@@ -0,0 +1,17 @@
+/**
+ * @file daemon.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief (De)Encryption daemon of vigenere (--daemon).
+ *
+ * @details Serves requests "E KEY LENGTH\n" or "D KEY LENGTH\n" followed by LENGTH bytes on a unix socket, with cached
+ *          tables and worker threads that never block on a client.
+ **/
+
+#ifndef DAEMON_H
+#define DAEMON_H
+
+void run_daemon(char *path, int threads);
+
+#endif
@@ -0,0 +1,161 @@
+/**
+ * @file keys.c
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Several keys at once of vigenere (--keys).
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#include "vigenere.h"
+#include "keys.h"
+#include "output.h"
+#include "stats.h"
+
+#define MULTI_KEY_BLOCK_SIZE (256 << 10) // input block (de)encrypted with every key of --keys while cached (256 KiB)
+
+/**
+* Ciphering a Stream with several Keys
+* @brief Reads a file descriptor once and (de)encrypts every block with every key to the output of that key.
+* @details A block of MULTI_KEY_BLOCK_SIZE bytes is classified once (letter values, special characters, \n) by
+*          vigenere_classify_block, then every key only adds its key stream to the classes with vigenere_cipher_block_classified, while
+*          the block and its classes are in the cache. Every key keeps its own key index, all of them start at 0.
+*
+* @param tables cipher tables of the keys
+* @param keys number of keys
+* @param fd input file descriptor
+* @param writers buffered outputs of the keys
+* @return 0 on success, -1 on a read error
+*/
+static int cipher_stream_keys(vigenere_table *tables, size_t keys, int fd, output_writer *writers){
+    char *buffer = malloc(MULTI_KEY_BLOCK_SIZE);
+    unsigned char *classes = malloc(MULTI_KEY_BLOCK_SIZE);
+    size_t *indices = calloc(keys, sizeof(size_t));
+    if(buffer == NULL || classes == NULL || indices == NULL){
+        usage("./vigenere: error occured while allocating the input buffer.");
+    }
+
+    ssize_t length;
+    while((length = stats_read(fd, buffer, MULTI_KEY_BLOCK_SIZE)) != 0){
+        if(length == -1){
+            if(errno == EINTR){
+                continue;
+            }
+            free(indices);
+            free(classes);
+            free(buffer);
+            return -1;
+        }
+
+        double start = stats_mode == STATS_OFF ? 0 : stats_clock();
+        vigenere_classify_block(buffer, classes, length);
+        if(stats_mode != STATS_OFF){
+            stats_text(buffer, length, keys);
+            stats_count(STATS_TRANSFORM, -1, 0, start);
+        }
+        for(size_t k = 0; k < keys; k++){
+            output_writer *writer = &writers[k];
+            for(size_t done = 0; done < (size_t) length; ){
+                if(writer->used == OUTPUT_BUFFER_SIZE){
+                    flush_output(writer);
+                }
+                size_t chunk = OUTPUT_BUFFER_SIZE - writer->used;
+                if(chunk > length - done){
+                    chunk = length - done;
+                }
+                start = stats_mode == STATS_OFF ? 0 : stats_clock();
+                indices[k] = vigenere_cipher_block_classified(&tables[k], buffer + done, classes + done,
+                                                     writer->buffer + writer->used, chunk, indices[k]);
+                if(stats_mode != STATS_OFF){
+                    stats_count(STATS_TRANSFORM, -1, chunk, start);
+                }
+                writer->used += chunk;
+                done += chunk;
+            }
+        }
+    }
+
+    free(indices);
+    free(classes);
+    free(buffer);
+    return 0;
+}
+
+/**
+* Ciphering with several Keys
+* @brief (De)encrypts the input files or stdin with every key given with --keys in one pass.
+* @details The output of a key goes to <outfile>.<key>, with the key as given on the command line.
+*
+* @param args parsed arguments (keys, outfile, decrypt, input_files)
+* @param argc number of arguments
+* @param argv array of all arguments
+*/
+void cipher_keys(arguments *args, int argc, char *argv[]){
+    size_t keys = 1;
+    for(char *c = args->keys; *c != '\0'; c++){
+        keys += *c == ',';
+    }
+
+    vigenere_table *tables = malloc(keys * sizeof(vigenere_table));
+    output_writer *writers = malloc(keys * sizeof(output_writer));
+    char *list = strdup(args->keys);
+    if(tables == NULL || writers == NULL || list == NULL){
+        usage("./vigenere: error occured while allocating the keys.");
+    }
+
+    char *key = list;
+    for(size_t k = 0; k < keys; k++){
+        char *next = strchr(key, ',');
+        if(next != NULL){
+            *next = '\0';
+        }
+
+        char *outfile = malloc(strlen(args->outfile) + strlen(key) + 2);
+        if(outfile == NULL){
+            usage("./vigenere: error occured while allocating the keys.");
+        }
+        sprintf(outfile, "%s.%s", args->outfile, key);
+
+        size_t key_length = strlen(key);
+        change_key(key, key_length);
+        prepare_table(&tables[k], key, key_length, &args->decrypt);
+        open_output(&writers[k], outfile);
+
+        key = next + 1;
+    }
+
+    int first = args->input_files == -1 ? argc : args->input_files;
+    for(int i = first; i <= argc; i++){
+        int fd = STDIN_FILENO;
+        if(i == argc && args->input_files != -1){
+            break;
+        }
+        if(i < argc){
+            fd = open(argv[i], O_RDONLY);
+            if(fd == -1){
+                usage("./viginere: Erorr occured while opening the input file.");
+            }
+        }
+        if(cipher_stream_keys(tables, keys, fd, writers) == -1){
+            usage("./vigenere: error occured while reading the input file.");
+        }
+        if(i < argc){
+            close(fd);
+        }
+    }
+
+    for(size_t k = 0; k < keys; k++){
+        close_output(&writers[k]);
+        free(writers[k].outfile);
+        vigenere_free_table(&tables[k]);
+    }
+    free(list);
+    free(writers);
+    free(tables);
+}
@@ -0,0 +1,18 @@
+/**
+ * @file keys.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Several keys at once of vigenere (--keys).
+ *
+ * @details The input is read once, every block is classified once and (de)encrypted with every key to its own output.
+ **/
+
+#ifndef KEYS_H
+#define KEYS_H
+
+#include "vigenere.h"
+
+void cipher_keys(arguments *args, int argc, char *argv[]);
+
+#endif
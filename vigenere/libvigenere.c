@@ -0,0 +1,843 @@
+/**
+ * @file libvigenere.c
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief (De)Encryption library of vigenere.
+ *
+ * @details Holds the cipher itself: the character classes, the translation tables of a key and the block kernels.
+ *          A vigenere_ctx keeps the tables and the current key index, so a stream can be (de)encrypted in buffers of
+ *          any size with vigenere_update, split anywhere, even inside a line. The library never exits the program
+ *          and does no I/O, errors are returned as VIGENERE_ERROR_* codes.
+ **/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "libvigenere_internal.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_KERNELS
+#include <immintrin.h>
+#endif
+
+#define MAX_VECTOR_WIDTH (64) // widest vector kernel (AVX-512), in bytes
+#define FIXED_KERNELS (16) // longest key length with its own scalar kernel
+
+// region: BYTE_CLASSES (vigenere_classify_block), a letter is its value 0-25 | 0x20 if lowercase
+#define CLASS_OTHER (0x40) // neither letter nor special character, translated by the table
+#define CLASS_SPECIAL (0x80) // special character, kept
+#define CLASS_NEWLINE (0xC0) // \n, kept and resets the key index
+
+/**
+* Converting a letter to [0-25] Range
+* @brief Covnerts a character to a range [0-25].
+* @details The function will turn all uppercase and lowercase alphabetical characters to a range of [0-25] and 
+*          give the corresponding value back.
+*
+* @param ch parsed character
+* @return the corresponding integer of the range [0-25], otherwise -1.
+*/
+int vigenere_convert_char(char ch){
+    if(ch >= 65 && ch <= 90){
+        return (int)(ch) - 65;
+    }
+    if(ch >=97 && ch <= 122){
+        return (int)(ch) - 97;
+    }
+    return -1;
+}
+
+/**
+* Lower or uppercase
+* @brief Returns the lowbound of the range needed.
+* @details This function will check for lower or uppercase and return accordingly 65 or 97 (starting ASCII values used
+*          for calculation). 
+*
+* @param ch parsed character
+* @return 65 for uppercase, 97 lowercase, otherwise -1.
+*/
+int vigenere_lower_upper(char ch){
+    if(ch >= 65 && ch <= 90){
+        return 65;
+    }
+    if(ch >=97 && ch <= 122){
+        return 97;
+    }
+    return -1;
+}
+
+/**
+* Special Character Check
+* @brief Checks whether the parsed character is special.
+* @details This function checks for .,:-!=?% and whitespaces, as well as for numbers and \n characters. 
+*
+* @param ch parsed character
+* @return 1 on ch=special, -1 otherwise.
+*/
+int vigenere_special_character(char ch){
+
+    if(ch >= 48 && ch <= 57){
+        return 1;
+    }
+
+    if(ch == '.'){
+        return 1;
+    }
+    if(ch == ','){
+        return 1;
+    }
+    if(ch == ':'){
+        return 1;
+    }
+    if(ch == '-'){
+        return 1;
+    }
+    if(ch == '!'){
+        return 1;
+    }
+    if(ch == '='){
+        return 1;
+    }
+    if(ch == '?'){
+        return 1;
+    }
+    if(ch == '%'){
+        return 1;
+    }
+    if(ch == ' '){
+        return 1;
+    }
+    if(ch == '\n'){
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+* (De)Encryption Function
+* @brief Takes a key and (de)encrypts the letter accordingly.
+* @details This function encrpyts one character on the following form: E[i] = (L[i] + K[i mod lK] mod 26.
+*          If the decrpyt flag is on (decrypt = 1), then it decrypts on the form: D[i] = (L[i] − K[i mod lK] + 26) mod 26.
+*          E[i] is the encrypted character. L[i] is the parsed character(letter). i is the index_counter (current index of)
+*          K is the key.
+*
+* @param decrypt decrypt flag
+* @param key (de)encryption key
+* @param letter character to be encrypted
+* @param index_counter index of the letter
+* @param key_length length of the key
+* @return (de)encrypted character
+*/
+char vigenere_de_encryption(int *decrypt, char *key, char letter, int index_counter, int key_length){
+    if(*decrypt != 1){
+        return (char) (((vigenere_convert_char(letter) + vigenere_convert_char(key[index_counter % key_length])) % 26) + vigenere_lower_upper(letter));
+    }
+    else{
+        return (char) (((vigenere_convert_char(letter) - vigenere_convert_char(key[index_counter % key_length]) + 26) % 26) + vigenere_lower_upper(letter));
+    }
+}
+
+/**
+* Ciphering a Block (scalar)
+* @brief (De)encrypts a block of bytes with the precomputed tables.
+* @details The index (index_counter mod key_length) is reset on every \n and advanced on every other byte.
+*          in and out may be the same buffer.
+*
+* @param table cipher table of the key
+* @param in input bytes
+* @param out output bytes (length bytes)
+* @param length number of bytes
+* @param index key index of the first byte
+* @return key index of the byte following the block
+*/
+static size_t cipher_block_scalar(vigenere_table *table, const char *in, char *out, size_t length, size_t index){
+    const unsigned char *input = (const unsigned char *) in;
+    unsigned char *output = (unsigned char *) out;
+
+    for(size_t i = 0; i < length; i++){
+        unsigned char ch = input[i];
+        output[i] = table->table[index * 256 + ch];
+        if(ch == '\n'){
+            index = 0;
+        }
+        else if(++index == table->key_length){
+            index = 0;
+        }
+    }
+
+    return index;
+}
+
+#ifdef __GNUC__
+#define UNROLL_PERIOD _Pragma("GCC unroll 16")
+#else
+#define UNROLL_PERIOD
+#endif
+
+/*
+ * FIXED_SCALAR_KERNEL(L) defines cipher_block_scalar_L, the scalar kernel for keys of length L. With L known at compile
+ * time, the wrap of the index is a compare against a constant and a whole key period starting at index 0 is unrolled,
+ * with the row of every key position at a constant offset. A period is left early at a \n (the index is 0 again).
+ */
+#define FIXED_SCALAR_KERNEL(L) \
+static size_t cipher_block_scalar_##L(vigenere_table *table, const char *in, char *out, size_t length, size_t index){ \
+    const unsigned char *input = (const unsigned char *) in; \
+    unsigned char *output = (unsigned char *) out; \
+    const unsigned char *rows = table->table; \
+    size_t i = 0; \
+    while(i < length){ \
+        if(index == 0 && length - i >= L){ \
+            size_t k = 0; \
+            UNROLL_PERIOD \
+            for(; k < L; k++){ \
+                unsigned char ch = input[i + k]; \
+                output[i + k] = rows[k * 256 + ch]; \
+                if(ch == '\n'){ \
+                    break; \
+                } \
+            } \
+            i += k < L ? k + 1 : L; \
+            continue; \
+        } \
+        unsigned char ch = input[i++]; \
+        output[i - 1] = rows[index * 256 + ch]; \
+        index = ch == '\n' || index + 1 == L ? 0 : index + 1; \
+    } \
+    return index; \
+}
+
+FIXED_SCALAR_KERNEL(1)
+FIXED_SCALAR_KERNEL(2)
+FIXED_SCALAR_KERNEL(3)
+FIXED_SCALAR_KERNEL(4)
+FIXED_SCALAR_KERNEL(5)
+FIXED_SCALAR_KERNEL(6)
+FIXED_SCALAR_KERNEL(7)
+FIXED_SCALAR_KERNEL(8)
+FIXED_SCALAR_KERNEL(9)
+FIXED_SCALAR_KERNEL(10)
+FIXED_SCALAR_KERNEL(11)
+FIXED_SCALAR_KERNEL(12)
+FIXED_SCALAR_KERNEL(13)
+FIXED_SCALAR_KERNEL(14)
+FIXED_SCALAR_KERNEL(15)
+FIXED_SCALAR_KERNEL(16)
+
+/*
+ * Fixed-length scalar kernels, indexed by key length (entry 0 is unused).
+ */
+static size_t (*const fixed_kernels[FIXED_KERNELS + 1])(vigenere_table *, const char *, char *, size_t, size_t) = {
+    NULL,
+    cipher_block_scalar_1, cipher_block_scalar_2, cipher_block_scalar_3, cipher_block_scalar_4,
+    cipher_block_scalar_5, cipher_block_scalar_6, cipher_block_scalar_7, cipher_block_scalar_8,
+    cipher_block_scalar_9, cipher_block_scalar_10, cipher_block_scalar_11, cipher_block_scalar_12,
+    cipher_block_scalar_13, cipher_block_scalar_14, cipher_block_scalar_15, cipher_block_scalar_16
+};
+
+/**
+* Ciphering a Classified Block (scalar)
+* @brief The scalar kernels translate every byte with one lookup anyway, so the classes are not used.
+*/
+static size_t cipher_classified_scalar(vigenere_table *table, const char *in, const unsigned char *classes, char *out,
+                                       size_t length, size_t index){
+    (void) classes;
+    return table->scalar(table, in, out, length, index);
+}
+
+#ifdef VECTOR_KERNELS
+
+/*
+ * The vector kernels classify a whole vector at once: letters are shifted by the key stream and reduced mod 26
+ * with a compare and subtract, special characters are passed through and every other byte becomes the constant of its
+ * key position from other_stream. Every \n of a vector restarts both streams in the lane after it: those lanes load
+ * them again from key_stream - lane (index 0 in that lane). So every byte is translated exactly as by the tables, and
+ * a vector always advances by its full width. The index advance per vector (width mod key_length) is computed once,
+ * after a \n the index is the distance to the last \n mod key_length. With a key of one letter the streams are the
+ * same in every lane and the index always 0, so the \n are not looked at.
+ */
+
+// unsigned range check lo <= x < lo + n on signed byte compares
+#define SSE2_IN_RANGE(x, lo, n) _mm_cmplt_epi8(_mm_add_epi8((x), _mm_set1_epi8((char) (-128 - (lo)))), _mm_set1_epi8((char) (-128 + (n))))
+#define AVX2_IN_RANGE(x, lo, n) _mm256_cmpgt_epi8(_mm256_set1_epi8((char) (-128 + (n))), _mm256_add_epi8((x), _mm256_set1_epi8((char) (-128 - (lo)))))
+// mask ? a : b per byte, SSE2 has no blendv
+#define SSE2_BLEND(mask, a, b) _mm_or_si128(_mm_and_si128((mask), (a)), _mm_andnot_si128((mask), (b)))
+
+/**
+* Ciphering a Block (SSE2)
+* @brief 16 byte vector kernel, see cipher_block_scalar.
+*/
+__attribute__((target("sse2")))
+static size_t cipher_block_sse2(vigenere_table *table, const char *in, char *out, size_t length, size_t index){
+    const size_t step = 16 % table->key_length;
+    const __m128i lanes = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    size_t i = 0;
+
+    while(i + 16 <= length){
+        __m128i x = _mm_loadu_si128((const __m128i *) (in + i));
+        __m128i folded = _mm_or_si128(x, _mm_set1_epi8(0x20));
+        __m128i letter = SSE2_IN_RANGE(folded, 'a', 26);
+        __m128i special = _mm_or_si128(SSE2_IN_RANGE(x, '0', 11), SSE2_IN_RANGE(x, ',', 3)); // 0-9 : , - .
+        __m128i newline = _mm_cmpeq_epi8(x, _mm_set1_epi8('\n'));
+        special = _mm_or_si128(special, newline);
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(x, _mm_set1_epi8(' ')));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(x, _mm_set1_epi8('!')));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(x, _mm_set1_epi8('%')));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(x, _mm_set1_epi8('=')));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(x, _mm_set1_epi8('?')));
+
+        __m128i shift = _mm_loadu_si128((const __m128i *) (table->key_stream + index));
+        __m128i other = _mm_loadu_si128((const __m128i *) (table->other_stream + index));
+        int newlines = _mm_movemask_epi8(newline);
+        if(newlines != 0 && table->key_length > 1){
+            for(int rest = newlines & 0x7FFF; rest != 0; rest &= rest - 1){
+                int lane = __builtin_ctz(rest) + 1;
+                __m128i after = _mm_cmpgt_epi8(lanes, _mm_set1_epi8((char) (lane - 1)));
+                shift = SSE2_BLEND(after, _mm_loadu_si128((const __m128i *) (table->key_stream - lane)), shift);
+                other = SSE2_BLEND(after, _mm_loadu_si128((const __m128i *) (table->other_stream - lane)), other);
+            }
+            index = (size_t) (__builtin_clz(newlines) - 16) % table->key_length;
+        }
+        else{
+            index += step;
+            if(index >= table->key_length){
+                index -= table->key_length;
+            }
+        }
+
+        __m128i sum = _mm_add_epi8(_mm_sub_epi8(folded, _mm_set1_epi8('a')), shift);
+        sum = _mm_sub_epi8(sum, _mm_and_si128(_mm_cmpgt_epi8(sum, _mm_set1_epi8(25)), _mm_set1_epi8(26)));
+        __m128i result = _mm_or_si128(_mm_add_epi8(sum, _mm_set1_epi8('A')), _mm_and_si128(x, _mm_set1_epi8(0x20)));
+
+        result = SSE2_BLEND(letter, result, SSE2_BLEND(special, x, other));
+        _mm_storeu_si128((__m128i *) (out + i), result);
+        i += 16;
+    }
+
+    return table->scalar(table, in + i, out + i, length - i, index);
+}
+
+/**
+* Ciphering a Block (AVX2)
+* @brief 32 byte vector kernel, see cipher_block_scalar.
+*/
+__attribute__((target("avx2")))
+static size_t cipher_block_avx2(vigenere_table *table, const char *in, char *out, size_t length, size_t index){
+    const size_t step = 32 % table->key_length;
+    const __m256i lanes = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                           16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+    size_t i = 0;
+
+    while(i + 32 <= length){
+        __m256i x = _mm256_loadu_si256((const __m256i *) (in + i));
+        __m256i folded = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+        __m256i letter = AVX2_IN_RANGE(folded, 'a', 26);
+        __m256i special = _mm256_or_si256(AVX2_IN_RANGE(x, '0', 11), AVX2_IN_RANGE(x, ',', 3));
+        __m256i newline = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n'));
+        special = _mm256_or_si256(special, newline);
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')));
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('!')));
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('%')));
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('=')));
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('?')));
+
+        __m256i shift = _mm256_loadu_si256((const __m256i *) (table->key_stream + index));
+        __m256i other = _mm256_loadu_si256((const __m256i *) (table->other_stream + index));
+        unsigned int newlines = (unsigned int) _mm256_movemask_epi8(newline);
+        if(newlines != 0 && table->key_length > 1){
+            for(unsigned int rest = newlines & 0x7FFFFFFFu; rest != 0; rest &= rest - 1){
+                int lane = __builtin_ctz(rest) + 1;
+                __m256i after = _mm256_cmpgt_epi8(lanes, _mm256_set1_epi8((char) (lane - 1)));
+                shift = _mm256_blendv_epi8(shift, _mm256_loadu_si256((const __m256i *) (table->key_stream - lane)), after);
+                other = _mm256_blendv_epi8(other, _mm256_loadu_si256((const __m256i *) (table->other_stream - lane)), after);
+            }
+            index = (size_t) __builtin_clz(newlines) % table->key_length;
+        }
+        else{
+            index += step;
+            if(index >= table->key_length){
+                index -= table->key_length;
+            }
+        }
+
+        __m256i sum = _mm256_add_epi8(_mm256_sub_epi8(folded, _mm256_set1_epi8('a')), shift);
+        sum = _mm256_sub_epi8(sum, _mm256_and_si256(_mm256_cmpgt_epi8(sum, _mm256_set1_epi8(25)), _mm256_set1_epi8(26)));
+        __m256i result = _mm256_or_si256(_mm256_add_epi8(sum, _mm256_set1_epi8('A')), _mm256_and_si256(x, _mm256_set1_epi8(0x20)));
+
+        result = _mm256_blendv_epi8(_mm256_blendv_epi8(other, x, special), result, letter);
+        _mm256_storeu_si256((__m256i *) (out + i), result);
+        i += 32;
+    }
+
+    return table->scalar(table, in + i, out + i, length - i, index);
+}
+
+/**
+* Ciphering a Block (AVX-512)
+* @brief 64 byte vector kernel with mask registers, see cipher_block_scalar.
+*/
+__attribute__((target("avx512f,avx512bw")))
+static size_t cipher_block_avx512(vigenere_table *table, const char *in, char *out, size_t length, size_t index){
+    const size_t step = 64 % table->key_length;
+    size_t i = 0;
+
+    while(i + 64 <= length){
+        __m512i x = _mm512_loadu_si512((const void *) (in + i));
+        __m512i folded = _mm512_or_si512(x, _mm512_set1_epi8(0x20));
+        __mmask64 letter = _mm512_cmplt_epu8_mask(_mm512_sub_epi8(folded, _mm512_set1_epi8('a')), _mm512_set1_epi8(26));
+        __mmask64 newline = _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8('\n'));
+        __mmask64 special = newline
+            | _mm512_cmplt_epu8_mask(_mm512_sub_epi8(x, _mm512_set1_epi8('0')), _mm512_set1_epi8(11))
+            | _mm512_cmplt_epu8_mask(_mm512_sub_epi8(x, _mm512_set1_epi8(',')), _mm512_set1_epi8(3))
+            | _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8(' '))
+            | _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8('!'))
+            | _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8('%'))
+            | _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8('='))
+            | _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8('?'));
+
+        __m512i shift = _mm512_loadu_si512((const void *) (table->key_stream + index));
+        __m512i other = _mm512_loadu_si512((const void *) (table->other_stream + index));
+        if(newline != 0 && table->key_length > 1){
+            for(__mmask64 rest = newline & ~((__mmask64) 1 << 63); rest != 0; rest &= rest - 1){
+                int lane = __builtin_ctzll(rest) + 1;
+                __mmask64 after = ~(__mmask64) 0 << lane;
+                shift = _mm512_mask_loadu_epi8(shift, after, table->key_stream - lane);
+                other = _mm512_mask_loadu_epi8(other, after, table->other_stream - lane);
+            }
+            index = (size_t) __builtin_clzll(newline) % table->key_length;
+        }
+        else{
+            index += step;
+            if(index >= table->key_length){
+                index -= table->key_length;
+            }
+        }
+
+        __m512i sum = _mm512_add_epi8(_mm512_sub_epi8(folded, _mm512_set1_epi8('a')), shift);
+        sum = _mm512_mask_sub_epi8(sum, _mm512_cmpgt_epi8_mask(sum, _mm512_set1_epi8(25)), sum, _mm512_set1_epi8(26));
+        __m512i result = _mm512_or_si512(_mm512_add_epi8(sum, _mm512_set1_epi8('A')), _mm512_and_si512(x, _mm512_set1_epi8(0x20)));
+
+        _mm512_storeu_si512((void *) (out + i), _mm512_mask_blend_epi8(letter, _mm512_mask_blend_epi8(special, other, x), result));
+        i += 64;
+    }
+
+    return table->scalar(table, in + i, out + i, length - i, index);
+}
+
+/*
+ * The classified kernels get the classes of vigenere_classify_block next to the input, so per vector they only load them,
+ * add the key stream to the letter values and reduce mod 26; the special characters and \n are already known.
+ * Bytes of CLASS_OTHER and the lanes after a \n are handled as in the kernels above.
+ */
+
+/**
+* Ciphering a Classified Block (SSE2)
+* @brief 16 byte classified kernel, see vigenere_cipher_block_classified.
+*/
+__attribute__((target("sse2")))
+static size_t cipher_classified_sse2(vigenere_table *table, const char *in, const unsigned char *classes, char *out,
+                                     size_t length, size_t index){
+    const size_t step = 16 % table->key_length;
+    const __m128i lanes = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    size_t i = 0;
+
+    while(i + 16 <= length){
+        __m128i c = _mm_loadu_si128((const __m128i *) (classes + i));
+        __m128i x = _mm_loadu_si128((const __m128i *) (in + i));
+        __m128i letter = _mm_cmpeq_epi8(_mm_and_si128(c, _mm_set1_epi8((char) 0xC0)), _mm_setzero_si128());
+        __m128i kept = _mm_cmpeq_epi8(_mm_and_si128(c, _mm_set1_epi8((char) CLASS_SPECIAL)), _mm_set1_epi8((char) CLASS_SPECIAL));
+        __m128i shift = _mm_loadu_si128((const __m128i *) (table->key_stream + index));
+        __m128i other = _mm_loadu_si128((const __m128i *) (table->other_stream + index));
+        int newlines = _mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8((char) CLASS_NEWLINE)));
+        if(newlines != 0 && table->key_length > 1){
+            for(int rest = newlines & 0x7FFF; rest != 0; rest &= rest - 1){
+                int lane = __builtin_ctz(rest) + 1;
+                __m128i after = _mm_cmpgt_epi8(lanes, _mm_set1_epi8((char) (lane - 1)));
+                shift = SSE2_BLEND(after, _mm_loadu_si128((const __m128i *) (table->key_stream - lane)), shift);
+                other = SSE2_BLEND(after, _mm_loadu_si128((const __m128i *) (table->other_stream - lane)), other);
+            }
+            index = (size_t) (__builtin_clz(newlines) - 16) % table->key_length;
+        }
+        else{
+            index += step;
+            if(index >= table->key_length){
+                index -= table->key_length;
+            }
+        }
+
+        __m128i sum = _mm_add_epi8(_mm_and_si128(c, _mm_set1_epi8(0x1F)), shift);
+        sum = _mm_sub_epi8(sum, _mm_and_si128(_mm_cmpgt_epi8(sum, _mm_set1_epi8(25)), _mm_set1_epi8(26)));
+        __m128i result = _mm_or_si128(_mm_add_epi8(sum, _mm_set1_epi8('A')), _mm_and_si128(c, _mm_set1_epi8(0x20)));
+
+        result = SSE2_BLEND(letter, result, SSE2_BLEND(kept, x, other));
+        _mm_storeu_si128((__m128i *) (out + i), result);
+        i += 16;
+    }
+
+    return table->scalar(table, in + i, out + i, length - i, index);
+}
+
+/**
+* Ciphering a Classified Block (AVX2)
+* @brief 32 byte classified kernel, see vigenere_cipher_block_classified. Also used for the AVX-512 kernel.
+*/
+__attribute__((target("avx2")))
+static size_t cipher_classified_avx2(vigenere_table *table, const char *in, const unsigned char *classes, char *out,
+                                     size_t length, size_t index){
+    const size_t step = 32 % table->key_length;
+    const __m256i lanes = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                           16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+    size_t i = 0;
+
+    while(i + 32 <= length){
+        __m256i c = _mm256_loadu_si256((const __m256i *) (classes + i));
+        __m256i x = _mm256_loadu_si256((const __m256i *) (in + i));
+        __m256i letter = _mm256_cmpeq_epi8(_mm256_and_si256(c, _mm256_set1_epi8((char) 0xC0)), _mm256_setzero_si256());
+        __m256i shift = _mm256_loadu_si256((const __m256i *) (table->key_stream + index));
+        __m256i other = _mm256_loadu_si256((const __m256i *) (table->other_stream + index));
+        unsigned int newlines = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(c, _mm256_set1_epi8((char) CLASS_NEWLINE)));
+        if(newlines != 0 && table->key_length > 1){
+            for(unsigned int rest = newlines & 0x7FFFFFFFu; rest != 0; rest &= rest - 1){
+                int lane = __builtin_ctz(rest) + 1;
+                __m256i after = _mm256_cmpgt_epi8(lanes, _mm256_set1_epi8((char) (lane - 1)));
+                shift = _mm256_blendv_epi8(shift, _mm256_loadu_si256((const __m256i *) (table->key_stream - lane)), after);
+                other = _mm256_blendv_epi8(other, _mm256_loadu_si256((const __m256i *) (table->other_stream - lane)), after);
+            }
+            index = (size_t) __builtin_clz(newlines) % table->key_length;
+        }
+        else{
+            index += step;
+            if(index >= table->key_length){
+                index -= table->key_length;
+            }
+        }
+
+        __m256i sum = _mm256_add_epi8(_mm256_and_si256(c, _mm256_set1_epi8(0x1F)), shift);
+        sum = _mm256_sub_epi8(sum, _mm256_and_si256(_mm256_cmpgt_epi8(sum, _mm256_set1_epi8(25)), _mm256_set1_epi8(26)));
+        __m256i result = _mm256_or_si256(_mm256_add_epi8(sum, _mm256_set1_epi8('A')), _mm256_and_si256(c, _mm256_set1_epi8(0x20)));
+
+        // the sign bit of a class is set for special characters and \n (kept), not for CLASS_OTHER
+        result = _mm256_blendv_epi8(_mm256_blendv_epi8(other, x, c), result, letter);
+        _mm256_storeu_si256((__m256i *) (out + i), result);
+        i += 32;
+    }
+
+    return table->scalar(table, in + i, out + i, length - i, index);
+}
+
+/**
+* Classifying a Block (AVX2)
+* @brief 32 byte version of vigenere_classify_block.
+*/
+__attribute__((target("avx2")))
+static size_t classify_block_avx2(const char *in, unsigned char *classes, size_t length){
+    size_t i = 0;
+
+    for(; i + 32 <= length; i += 32){
+        __m256i x = _mm256_loadu_si256((const __m256i *) (in + i));
+        __m256i folded = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+        __m256i letter = AVX2_IN_RANGE(folded, 'a', 26);
+        __m256i special = _mm256_or_si256(AVX2_IN_RANGE(x, '0', 11), AVX2_IN_RANGE(x, ',', 3));
+        __m256i newline = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n'));
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')));
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('!')));
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('%')));
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('=')));
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(x, _mm256_set1_epi8('?')));
+
+        __m256i value = _mm256_or_si256(_mm256_sub_epi8(folded, _mm256_set1_epi8('a')), _mm256_and_si256(x, _mm256_set1_epi8(0x20)));
+        __m256i c = _mm256_blendv_epi8(_mm256_set1_epi8((char) CLASS_OTHER), _mm256_set1_epi8((char) CLASS_SPECIAL), special);
+        c = _mm256_blendv_epi8(c, _mm256_set1_epi8((char) CLASS_NEWLINE), newline);
+        c = _mm256_blendv_epi8(c, value, letter);
+        _mm256_storeu_si256((__m256i *) (classes + i), c);
+    }
+
+    return i;
+}
+
+#endif
+
+/**
+* Selecting the Kernel
+* @brief Picks the widest block kernel supported by the CPU.
+* @details The scalar kernel is the fixed-length one for keys of up to FIXED_KERNELS letters, the generic one otherwise.
+*          The classified kernel matches the block kernel (the AVX2 one for AVX-512).
+*          The kernel can be forced by name (generic, scalar, sse2, avx2, avx512), an unknown or unsupported name keeps
+*          the scalar kernel and is reported.
+*
+* @param table cipher table of the key
+* @param forced name of the kernel to be used, NULL or empty for the widest one
+* @return 0 on success, -1 if the requested kernel is not supported
+*/
+static int select_kernel(vigenere_table *table, const char *forced){
+    if(forced != NULL && forced[0] == '\0'){
+        forced = NULL;
+    }
+    table->scalar = table->key_length <= FIXED_KERNELS ? fixed_kernels[table->key_length] : cipher_block_scalar;
+    if(forced != NULL && strcmp(forced, "generic") == 0){
+        table->scalar = cipher_block_scalar;
+    }
+    table->kernel = table->scalar;
+    table->classified = cipher_classified_scalar;
+
+    if(forced != NULL && (strcmp(forced, "scalar") == 0 || strcmp(forced, "generic") == 0)){
+        return 0;
+    }
+
+#ifdef VECTOR_KERNELS
+    __builtin_cpu_init();
+    int sse2 = __builtin_cpu_supports("sse2");
+    int avx2 = __builtin_cpu_supports("avx2");
+    int avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+
+    if(forced == NULL){
+        table->kernel = avx512 ? cipher_block_avx512 : avx2 ? cipher_block_avx2 : sse2 ? cipher_block_sse2 : table->scalar;
+        table->classified = avx2 ? cipher_classified_avx2 : sse2 ? cipher_classified_sse2 : cipher_classified_scalar;
+        return 0;
+    }
+    if(strcmp(forced, "sse2") == 0 && sse2){
+        table->kernel = cipher_block_sse2;
+        table->classified = cipher_classified_sse2;
+        return 0;
+    }
+    if(strcmp(forced, "avx2") == 0 && avx2){
+        table->kernel = cipher_block_avx2;
+        table->classified = cipher_classified_avx2;
+        return 0;
+    }
+    if(strcmp(forced, "avx512") == 0 && avx512){
+        table->kernel = cipher_block_avx512;
+        table->classified = cipher_classified_avx2;
+        return 0;
+    }
+#endif
+
+    return forced != NULL ? -1 : 0;
+}
+
+/**
+* Building the Cipher Table
+* @brief Precomputes the translation tables and the key stream for a key and selects the kernel.
+* @details Every byte is translated once per key position, exactly as a character at that index_counter would be:
+*          special characters are kept, everything else goes through vigenere_de_encryption.
+*
+* @param table table to be built
+* @param key uppercased (de)encryption key
+* @param key_length length of the key
+* @param decrypt decrypt flag (1 for present)
+* @param kernel name of the kernel to be used, NULL for the widest one the CPU supports
+* @return 0 on success, VIGENERE_ERROR_MEMORY or VIGENERE_ERROR_KERNEL (the table is freed then)
+*/
+int vigenere_build_table(vigenere_table *table, char *key, size_t key_length, int *decrypt, const char *kernel){
+    table->key_length = key_length;
+    table->table = malloc(key_length * 256);
+    unsigned char *streams = calloc(2, MAX_VECTOR_WIDTH + key_length + MAX_VECTOR_WIDTH);
+    table->key_stream = streams == NULL ? NULL : streams + MAX_VECTOR_WIDTH;
+    table->other_stream = streams == NULL ? NULL : table->key_stream + key_length + 2 * MAX_VECTOR_WIDTH;
+    if(table->table == NULL || streams == NULL){
+        vigenere_free_table(table);
+        return VIGENERE_ERROR_MEMORY;
+    }
+
+    for(size_t index = 0; index < key_length; index++){
+        unsigned char *row = table->table + index * 256;
+        for(int ch = 0; ch < 256; ch++){
+            if(vigenere_special_character((char) ch) == 1){
+                row[ch] = (unsigned char) ch;
+            }
+            else{
+                row[ch] = (unsigned char) vigenere_de_encryption(decrypt, key, (char) ch, index, key_length);
+            }
+        }
+    }
+
+    for(size_t i = 0; i < key_length + MAX_VECTOR_WIDTH; i++){
+        int shift = vigenere_convert_char(key[i % key_length]);
+        table->key_stream[i] = (unsigned char) (*decrypt == 1 ? (26 - shift) % 26 : shift);
+        table->other_stream[i] = table->table[(i % key_length) * 256]; // \0 is neither letter nor special character
+    }
+
+    if(select_kernel(table, kernel) == -1){
+        vigenere_free_table(table);
+        return VIGENERE_ERROR_KERNEL;
+    }
+    return 0;
+}
+
+/**
+* Freeing the Cipher Table
+* @brief Frees the tables and the streams.
+*
+* @param table cipher table of the key
+*/
+void vigenere_free_table(vigenere_table *table){
+    free(table->table);
+    free(table->key_stream == NULL ? NULL : table->key_stream - MAX_VECTOR_WIDTH);
+    table->table = NULL;
+    table->key_stream = NULL;
+    table->other_stream = NULL;
+}
+
+/**
+* Ciphering a Block
+* @brief (De)encrypts a block of bytes with the selected kernel.
+* @details in and out may be the same buffer.
+*
+* @param table cipher table of the key
+* @param in input bytes
+* @param out output bytes (length bytes)
+* @param length number of bytes
+* @param index key index of the first byte
+* @return key index of the byte following the block
+*/
+size_t vigenere_cipher_block(vigenere_table *table, const char *in, char *out, size_t length, size_t index){
+    return table->kernel(table, in, out, length, index);
+}
+
+/**
+* Classifying a Block
+* @brief Computes the class of every byte of a block once, for (de)encrypting it with several keys.
+* @details A letter gets its value 0-25, | 0x20 if it is lowercase, a special character CLASS_SPECIAL, \n CLASS_NEWLINE
+*          and every other byte CLASS_OTHER. The classes do not depend on the key, so vigenere_cipher_block_classified only
+*          adds the key stream of its key to them.
+*
+* @param in input bytes
+* @param classes classes of the bytes (length bytes)
+* @param length number of bytes
+*/
+void vigenere_classify_block(const char *in, unsigned char *classes, size_t length){
+    unsigned char class_of[256];
+    size_t i = 0;
+
+#ifdef VECTOR_KERNELS
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")){
+        i = classify_block_avx2(in, classes, length);
+    }
+#endif
+    if(i == length){
+        return;
+    }
+    for(int ch = 0; ch < 256; ch++){
+        int value = vigenere_convert_char((char) ch);
+        class_of[ch] = value != -1 ? (unsigned char) (value | (ch & 0x20)) : ch == '\n' ? CLASS_NEWLINE
+                     : vigenere_special_character((char) ch) == 1 ? CLASS_SPECIAL : CLASS_OTHER;
+    }
+    for(; i < length; i++){
+        classes[i] = class_of[(unsigned char) in[i]];
+    }
+}
+
+/**
+* Ciphering a Classified Block
+* @brief (De)encrypts a block of bytes whose classes were computed by vigenere_classify_block.
+* @details The result is the same as of vigenere_cipher_block. in and out may be the same buffer.
+*
+* @param table cipher table of the key
+* @param in input bytes
+* @param classes classes of the input bytes
+* @param out output bytes (length bytes)
+* @param length number of bytes
+* @param index key index of the first byte
+* @return key index of the byte following the block
+*/
+size_t vigenere_cipher_block_classified(vigenere_table *table, const char *in, const unsigned char *classes, char *out,
+                                        size_t length, size_t index){
+    return table->classified(table, in, classes, out, length, index);
+}
+
+/**
+* Initializing a Context
+* @brief Prepares a context for (de)encrypting a stream with a key.
+* @details The key is case-insensitive and must consist of letters only. The key index starts at 0.
+*          kernel forces a block kernel by name (generic, scalar, sse2, avx2 or avx512), NULL or an empty name picks the
+*          widest one the CPU supports.
+*
+* @param ctx context to be initialized
+* @param key (de)encryption key
+* @param decrypt nonzero to decrypt
+* @param kernel name of the kernel to be used, NULL for the widest one
+* @return 0 on success, VIGENERE_ERROR_KEY, VIGENERE_ERROR_MEMORY or VIGENERE_ERROR_KERNEL
+*/
+int vigenere_init(vigenere_ctx *ctx, const char *key, int decrypt, const char *kernel){
+    ctx->table = NULL;
+    ctx->index = 0;
+    size_t key_length = strlen(key);
+    if(key_length == 0){
+        return VIGENERE_ERROR_KEY;
+    }
+
+    char *upper = malloc(key_length + 1);
+    vigenere_table *table = malloc(sizeof(vigenere_table));
+    if(upper == NULL || table == NULL){
+        free(upper);
+        free(table);
+        return VIGENERE_ERROR_MEMORY;
+    }
+    for(size_t i = 0; i <= key_length; i++){
+        if(i < key_length && vigenere_convert_char(key[i]) == -1){
+            free(upper);
+            free(table);
+            return VIGENERE_ERROR_KEY;
+        }
+        upper[i] = key[i] >= 'a' && key[i] <= 'z' ? key[i] - 'a' + 'A' : key[i];
+    }
+
+    int flag = decrypt ? 1 : -1;
+    int result = vigenere_build_table(table, upper, key_length, &flag, kernel);
+    free(upper);
+    if(result != 0){
+        free(table);
+        return result;
+    }
+    ctx->table = table;
+    return 0;
+}
+
+/**
+* Updating a Context
+* @brief (De)encrypts the next bytes of the stream.
+* @details The key index is carried over from the previous call, so splitting a stream into buffers does not change
+*          the result. in and out may be the same buffer.
+*
+* @param ctx context
+* @param in input bytes
+* @param out output bytes (length bytes)
+* @param length number of bytes
+* @return number of bytes written to out (length)
+*/
+size_t vigenere_update(vigenere_ctx *ctx, const char *in, char *out, size_t length){
+    ctx->index = vigenere_cipher_block(ctx->table, in, out, length, ctx->index);
+    return length;
+}
+
+/**
+* Finishing a Stream
+* @brief Ends the current stream of a context.
+* @details Every byte is (de)encrypted by vigenere_update already, so nothing is written to out. The key index is reset,
+*          the context can be used for the next stream.
+*
+* @param ctx context
+* @param out output bytes (unused)
+* @return number of bytes written to out (0)
+*/
+size_t vigenere_final(vigenere_ctx *ctx, char *out){
+    (void) out;
+    ctx->index = 0;
+    return 0;
+}
+
+/**
+* Freeing a Context
+* @brief Frees the tables of a context.
+*
+* @param ctx context
+*/
+void vigenere_free(vigenere_ctx *ctx){
+    if(ctx->table != NULL){
+        vigenere_free_table(ctx->table);
+        free(ctx->table);
+        ctx->table = NULL;
+    }
+}
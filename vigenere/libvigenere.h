@@ -0,0 +1,44 @@
+/**
+ * @file libvigenere.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief (De)Encryption library of vigenere.
+ *
+ * @details Streaming use:
+ *          vigenere_ctx ctx;
+ *          vigenere_init(&ctx, "arslan", 0, NULL);
+ *          vigenere_update(&ctx, in, out, length); (any number of times, buffers split anywhere)
+ *          vigenere_final(&ctx, out);
+ *          vigenere_free(&ctx);
+ *          Letters are shifted by the key, digits, .,:-!=?% space and \n are kept, the key index restarts at every \n.
+ **/
+
+#ifndef LIBVIGENERE_H
+#define LIBVIGENERE_H
+
+#include <stddef.h>
+
+#define VIGENERE_ERROR_KEY (-1) // the key is empty or contains non-letters
+#define VIGENERE_ERROR_MEMORY (-2) // the tables could not be allocated
+#define VIGENERE_ERROR_KERNEL (-3) // the kernel requested at vigenere_init is not supported
+
+typedef struct vigenere_table vigenere_table; // precomputed tables of a key, see libvigenere_internal.h
+
+/**
+ * @struct vigenere_ctx
+ * @brief This structure represents the state of a stream being (de)encrypted.
+ * @details table holds the tables of the key, index is the key index (index_counter mod key_length) of the next byte
+ *          of the stream.
+ */
+typedef struct{
+    vigenere_table *table;
+    size_t index;
+} vigenere_ctx;
+
+int vigenere_init(vigenere_ctx *ctx, const char *key, int decrypt, const char *kernel);
+size_t vigenere_update(vigenere_ctx *ctx, const char *in, char *out, size_t length);
+size_t vigenere_final(vigenere_ctx *ctx, char *out);
+void vigenere_free(vigenere_ctx *ctx);
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * @file libvigenere_internal.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Internals of the vigenere library, shared with the vigenere program and its benchmark.
+ *
+ * @details Not part of the library interface: the character classes, the translation tables of a key and the block
+ *          functions working on them. Users of the library only need libvigenere.h.
+ **/
+
+#ifndef LIBVIGENERE_INTERNAL_H
+#define LIBVIGENERE_INTERNAL_H
+
+#include "libvigenere.h"
+
+/**
+ * @struct vigenere_table
+ * @brief This structure represents the precomputed translation tables of a key.
+ * @details For every key position there is one row of 256 entries, mapping every input byte to its output byte.
+ *          Special characters map to themselves, so a byte is (de)encrypted with one lookup:
+ *          table[index * 256 + byte], where index is the current index_counter mod key_length.
+ *          key_stream holds the shift of every key position (already negated for decryption), repeated for
+ *          key_length + MAX_VECTOR_WIDTH entries, so a vector kernel loads the shifts of a whole vector from key_stream + index.
+ *          other_stream holds the output of every key position for a byte that is neither letter nor special character
+ *          (the same for all such bytes) in the same layout. Both streams are preceded by MAX_VECTOR_WIDTH allocated
+ *          bytes, so the lanes after a \n at lane - 1 load them from key_stream - lane.
+ *          kernel is the block function selected for this CPU, scalar the scalar one for this key length (also used by
+ *          the vector kernels for the bytes after the last whole vector), classified the kernel for blocks classified by
+ *          vigenere_classify_block.
+ */
+struct vigenere_table{
+    size_t key_length;
+    unsigned char *table;
+    unsigned char *key_stream;
+    unsigned char *other_stream;
+    size_t (*kernel)(struct vigenere_table *table, const char *in, char *out, size_t length, size_t index);
+    size_t (*scalar)(struct vigenere_table *table, const char *in, char *out, size_t length, size_t index);
+    size_t (*classified)(struct vigenere_table *table, const char *in, const unsigned char *classes, char *out,
+                         size_t length, size_t index);
+};
+
+int vigenere_convert_char(char ch);
+int vigenere_lower_upper(char ch);
+int vigenere_special_character(char ch);
+char vigenere_de_encryption(int *decrypt, char *key, char letter, int index_counter, int key_length);
+int vigenere_build_table(vigenere_table *table, char *key, size_t key_length, int *decrypt, const char *kernel);
+void vigenere_free_table(vigenere_table *table);
+size_t vigenere_cipher_block(vigenere_table *table, const char *in, char *out, size_t length, size_t index);
+void vigenere_classify_block(const char *in, unsigned char *classes, size_t length);
+size_t vigenere_cipher_block_classified(vigenere_table *table, const char *in, const unsigned char *classes, char *out,
+                                        size_t length, size_t index);
+
+#endif
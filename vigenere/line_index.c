@@ -0,0 +1,528 @@
+/**
+ * @file line_index.c
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Line index of vigenere (--index, --lines and --bytes).
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "vigenere.h"
+#include "line_index.h"
+#include "output.h"
+#include "parallel.h"
+
+#define LINE_INDEX_MAGIC "VIGIDX2" // magic of a line index file (8 bytes with the terminator)
+#define LINE_INDEX_INTERVAL (64) // lines between two checkpoints of a line index
+
+/**
+ * @struct line_index_header
+ * @brief This structure represents the header of a line index file.
+ * @details A line index stores where every line of a file starts. Since the key index is reset on every \n and \n is
+ *          never (de)encrypted, the offsets are the same for the plaintext and the ciphertext.
+ *          The header is followed by the deltas (line lengths, including the \n) of the lines 0 .. lines - 2 as
+ *          LEB128 varints, padded to 8 bytes, then by the checkpoint table at checkpoint_table: for every interval-th
+ *          line one pair of uint64_t, its file offset and the position of its delta in the delta stream. file_size,
+ *          file_mtime and file_mtime_nsec are taken from the indexed file, an index that does not match them is stale.
+ *          All fields are native-endian.
+ */
+typedef struct{
+    char magic[8];
+    uint64_t file_size;
+    int64_t file_mtime;
+    int64_t file_mtime_nsec;
+    uint64_t lines;
+    uint64_t interval;
+    uint64_t checkpoints;
+    uint64_t checkpoint_table;
+} line_index_header;
+
+/**
+ * @struct line_index
+ * @brief This structure represents a memory-mapped line index.
+ */
+typedef struct{
+    void *mapping;
+    size_t length;
+    const line_index_header *header;
+    const uint64_t *checkpoints;
+    const unsigned char *deltas;
+    uint64_t deltas_length;
+} line_index;
+
+/**
+* Reading a Varint
+* @brief Decodes one LEB128 varint of the delta stream.
+* @details A varint running past the end of the stream or longer than 64 bits means a truncated or corrupt index.
+*
+* @param deltas delta stream
+* @param length length of the delta stream
+* @param position position in the stream, advanced past the varint
+* @param value decoded value
+* @return 0 on success, -1 if the stream is corrupt
+*/
+static int read_varint(const unsigned char *deltas, uint64_t length, uint64_t *position, uint64_t *value){
+    *value = 0;
+    for(int shift = 0; shift < 64; shift += 7){
+        if(*position >= length){
+            return -1;
+        }
+        unsigned char byte = deltas[(*position)++];
+        *value |= (uint64_t) (byte & 0x7F) << shift;
+        if(!(byte & 0x80)){
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+* Writing a Varint
+* @brief Encodes a value as LEB128 varint to the output.
+*
+* @param writer buffered output
+* @param value value to be encoded
+* @return number of bytes written
+*/
+static uint64_t write_varint(output_writer *writer, uint64_t value){
+    unsigned char bytes[10];
+    int length = 0;
+    do{
+        bytes[length] = value & 0x7F;
+        value >>= 7;
+        if(value != 0){
+            bytes[length] |= 0x80;
+        }
+        length++;
+    } while(value != 0);
+    write_output(writer, (char *) bytes, length);
+    return length;
+}
+
+/**
+* Building a Line Index
+* @brief Scans a file for \n and writes its line index.
+* @details The index is written to index_file.tmp first and renamed when complete, so a reader never maps a partial index.
+*
+* @param fd file descriptor of the indexed file
+* @param st status of the indexed file
+* @param index_file path of the index
+*/
+static void build_line_index(int fd, struct stat *st, char *index_file){
+    line_index_header header;
+    output_writer writer;
+    size_t checkpoints_size = 1024;
+    uint64_t *checkpoints = malloc(checkpoints_size * 2 * sizeof(uint64_t));
+    char *buffer = malloc(INPUT_BUFFER_SIZE);
+    char *temporary = malloc(strlen(index_file) + 5);
+    if(checkpoints == NULL || buffer == NULL || temporary == NULL){
+        usage("./vigenere: error occured while allocating the line index.");
+    }
+    sprintf(temporary, "%s.tmp", index_file);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LINE_INDEX_MAGIC, sizeof(header.magic));
+    header.file_size = st->st_size;
+    header.file_mtime = st->st_mtim.tv_sec;
+    header.file_mtime_nsec = st->st_mtim.tv_nsec;
+    header.interval = LINE_INDEX_INTERVAL;
+
+    open_output(&writer, temporary);
+    write_output(&writer, (char *) &header, sizeof(header));
+
+    uint64_t line = 0;
+    uint64_t line_start = 0;
+    uint64_t position = 0;
+    off_t offset = 0;
+    ssize_t length;
+
+    checkpoints[0] = 0;
+    checkpoints[1] = 0;
+    header.checkpoints = 1;
+
+    while(offset < st->st_size && (length = read_region(fd, buffer, INPUT_BUFFER_SIZE, offset)) > 0){
+        char *next = buffer;
+        char *end = buffer + length;
+        while((next = memchr(next, '\n', end - next)) != NULL){
+            uint64_t start = offset + (next - buffer) + 1;
+            position += write_varint(&writer, start - line_start);
+            line_start = start;
+            line++;
+            next++;
+
+            if(line % LINE_INDEX_INTERVAL == 0){
+                if(header.checkpoints == checkpoints_size){
+                    checkpoints_size *= 2;
+                    checkpoints = realloc(checkpoints, checkpoints_size * 2 * sizeof(uint64_t));
+                    if(checkpoints == NULL){
+                        usage("./vigenere: error occured while allocating the line index.");
+                    }
+                }
+                checkpoints[header.checkpoints * 2] = line_start;
+                checkpoints[header.checkpoints * 2 + 1] = position;
+                header.checkpoints++;
+            }
+        }
+        offset += length;
+    }
+    if(offset < st->st_size){
+        usage("./vigenere: error occured while reading the input file.");
+    }
+
+    header.lines = line + 1;
+    header.checkpoint_table = sizeof(header) + position;
+    while(header.checkpoint_table % sizeof(uint64_t) != 0){
+        write_output(&writer, "", 1);
+        header.checkpoint_table++;
+    }
+    write_output(&writer, (char *) checkpoints, header.checkpoints * 2 * sizeof(uint64_t));
+    flush_output(&writer);
+    if(pwrite(writer.fd, &header, sizeof(header), 0) != sizeof(header)){
+        usage("./vigenere: error occured while writing the line index.");
+    }
+    close_output(&writer);
+
+    if(rename(temporary, index_file) == -1){
+        usage("./vigenere: error occured while writing the line index.");
+    }
+
+    free(temporary);
+    free(buffer);
+    free(checkpoints);
+}
+
+/**
+* Opening a Line Index
+* @brief Maps a line index and checks it against the indexed file.
+*
+* @param index line index to be opened
+* @param index_file path of the index
+* @param st status of the indexed file
+* @return 0 on success, -1 if the index is missing, invalid or stale
+*/
+static int open_line_index(line_index *index, char *index_file, struct stat *st){
+    struct stat index_st;
+    int fd = open(index_file, O_RDONLY);
+    if(fd == -1){
+        return -1;
+    }
+    if(fstat(fd, &index_st) == -1 || index_st.st_size < (off_t) sizeof(line_index_header)){
+        close(fd);
+        return -1;
+    }
+
+    index->length = index_st.st_size;
+    index->mapping = mmap(NULL, index->length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(index->mapping == MAP_FAILED){
+        return -1;
+    }
+
+    index->header = index->mapping;
+    index->deltas = (const unsigned char *) index->mapping + sizeof(line_index_header);
+    index->deltas_length = index->header->checkpoint_table - sizeof(line_index_header);
+    index->checkpoints = (const uint64_t *) ((const char *) index->mapping + index->header->checkpoint_table);
+
+    const line_index_header *header = index->header;
+    if(memcmp(header->magic, LINE_INDEX_MAGIC, sizeof(header->magic)) != 0 || header->file_size != (uint64_t) st->st_size
+       || header->file_mtime != (int64_t) st->st_mtim.tv_sec || header->file_mtime_nsec != (int64_t) st->st_mtim.tv_nsec
+       || header->lines == 0 || header->interval == 0
+       || header->checkpoints != (header->lines + header->interval - 1) / header->interval
+       || header->checkpoint_table < sizeof(line_index_header) || header->checkpoint_table % sizeof(uint64_t) != 0
+       || header->checkpoint_table + header->checkpoints * 2 * sizeof(uint64_t) != index->length){
+        munmap(index->mapping, index->length);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+* Closing a Line Index
+* @brief Unmaps a line index.
+*
+* @param index line index
+*/
+static void close_line_index(line_index *index){
+    munmap(index->mapping, index->length);
+}
+
+/**
+* Line Start from the Index
+* @brief Returns the offset of a line with the index.
+* @details Decodes at most interval - 1 deltas after the checkpoint of the line.
+*
+* @param index line index
+* @param line line number (0-based)
+* @return file offset of the line, the file size if the file has fewer lines, -1 if the index is corrupt
+*/
+static off_t index_line_start(line_index *index, unsigned long long line){
+    const line_index_header *header = index->header;
+    if(line >= header->lines){
+        return header->file_size;
+    }
+
+    uint64_t checkpoint = line / header->interval;
+    uint64_t offset = index->checkpoints[checkpoint * 2];
+    uint64_t position = index->checkpoints[checkpoint * 2 + 1];
+    uint64_t delta;
+    for(uint64_t i = checkpoint * header->interval; i < line; i++){
+        if(read_varint(index->deltas, index->deltas_length, &position, &delta) == -1){
+            return -1;
+        }
+        offset += delta;
+    }
+    return offset <= header->file_size ? (off_t) offset : -1;
+}
+
+/**
+* Line of an Offset from the Index
+* @brief Returns the offset of the line containing a byte with the index.
+* @details Binary searches the checkpoints, then decodes the deltas after the checkpoint.
+*
+* @param index line index
+* @param offset file offset of the byte
+* @return file offset of its line, -1 if the index is corrupt
+*/
+static off_t index_line_of_offset(line_index *index, off_t offset){
+    const line_index_header *header = index->header;
+    uint64_t low = 0;
+    uint64_t high = header->checkpoints - 1;
+    while(low < high){
+        uint64_t middle = (low + high + 1) / 2;
+        if(index->checkpoints[middle * 2] <= (uint64_t) offset){
+            low = middle;
+        }
+        else{
+            high = middle - 1;
+        }
+    }
+
+    uint64_t line = low * header->interval;
+    uint64_t start = index->checkpoints[low * 2];
+    uint64_t position = index->checkpoints[low * 2 + 1];
+    uint64_t delta;
+    if(start > (uint64_t) offset){
+        return -1;
+    }
+    while(line + 1 < header->lines){
+        if(read_varint(index->deltas, index->deltas_length, &position, &delta) == -1){
+            return -1;
+        }
+        uint64_t next = start + delta;
+        if(next > (uint64_t) offset){
+            break;
+        }
+        start = next;
+        line++;
+    }
+    return start;
+}
+
+/**
+* Scanning for a Line
+* @brief Returns the offset of a line by scanning forward for \n.
+*
+* @param fd input file descriptor
+* @param offset offset of a known line
+* @param from number of that line (0-based)
+* @param line line to be found (0-based, from <= line)
+* @param size size of the file
+* @return file offset of the line, size if the file has fewer lines, -1 on a read error
+*/
+static off_t scan_line_start(int fd, off_t offset, unsigned long long from, unsigned long long line, off_t size){
+    char *buffer = malloc(INPUT_BUFFER_SIZE);
+    if(buffer == NULL){
+        usage("./vigenere: error occured while allocating the input buffer.");
+    }
+
+    while(from < line && offset < size){
+        ssize_t length = read_region(fd, buffer, INPUT_BUFFER_SIZE, offset);
+        if(length <= 0){
+            free(buffer);
+            return -1;
+        }
+        char *next = buffer;
+        char *end = buffer + length;
+        while(from < line && (next = memchr(next, '\n', end - next)) != NULL){
+            next++;
+            from++;
+        }
+        offset += from < line ? length : next - buffer;
+    }
+
+    free(buffer);
+    return from < line ? size : offset;
+}
+
+/**
+* Scanning back for a Line
+* @brief Returns the offset of the line containing a byte by scanning backwards for \n.
+*
+* @param fd input file descriptor
+* @param offset file offset of the byte
+* @return file offset of its line, -1 on a read error
+*/
+static off_t scan_back_line_start(int fd, off_t offset){
+    char *buffer = malloc(INPUT_BUFFER_SIZE);
+    if(buffer == NULL){
+        usage("./vigenere: error occured while allocating the input buffer.");
+    }
+
+    while(offset > 0){
+        off_t start = offset > INPUT_BUFFER_SIZE ? offset - INPUT_BUFFER_SIZE : 0;
+        if(read_region(fd, buffer, offset - start, start) != offset - start){
+            free(buffer);
+            return -1;
+        }
+        for(off_t i = offset - start; i > 0; i--){
+            if(buffer[i - 1] == '\n'){
+                free(buffer);
+                return start + i;
+            }
+        }
+        offset = start;
+    }
+
+    free(buffer);
+    return 0;
+}
+
+/**
+* Ensuring a Line Index
+* @brief Opens the line index of a file, building it first if it is missing or stale.
+*
+* @param index line index to be opened
+* @param fd file descriptor of the indexed file
+* @param st status of the indexed file
+* @param index_file path of the index
+*/
+static void ensure_line_index(line_index *index, int fd, struct stat *st, char *index_file){
+    if(open_line_index(index, index_file, st) == 0){
+        return;
+    }
+    build_line_index(fd, st, index_file);
+    if(open_line_index(index, index_file, st) == -1){
+        usage("./vigenere: error occured while opening the line index.");
+    }
+}
+
+/**
+* Ciphering a Range
+* @brief (De)encrypts only the lines or bytes given with --lines or --bytes.
+* @details The key index is reset on every \n, so the key index of the first byte of the range follows from the start of
+*          its line: at a line start it is 0, inside a line it is the distance to the line start mod key_length.
+*          Line starts are looked up in the line index if --index is given (building it if needed), otherwise, or if
+*          the index turns out to be corrupt, they are found by scanning the file. Nothing before the range is
+*          (de)encrypted.
+*
+* @param table cipher table of the key
+* @param file input file
+* @param args parsed arguments (range, index_file)
+* @param writer buffered output
+*/
+void cipher_range(vigenere_table *table, char *file, arguments *args, output_writer *writer){
+    struct stat st;
+    line_index index;
+    off_t start;
+    off_t end;
+    size_t key_index = 0;
+
+    int fd = open(file, O_RDONLY);
+    if(fd == -1){
+        usage("./viginere: Erorr occured while opening the input file.");
+    }
+    if(fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)){
+        usage("./vigenere: options --lines and --bytes need a regular input file.");
+    }
+
+    if(args->index_file != NULL){
+        ensure_line_index(&index, fd, &st, args->index_file);
+    }
+
+    int indexed = args->index_file != NULL;
+    if(args->range == RANGE_LINES){
+        if(indexed){
+            start = index_line_start(&index, args->range_first - 1);
+            end = start == -1 || args->range_last == ULLONG_MAX ? st.st_size : index_line_start(&index, args->range_last);
+            indexed = start != -1 && end != -1; // a corrupt index is not used
+        }
+        if(!indexed){
+            start = scan_line_start(fd, 0, 0, args->range_first - 1, st.st_size);
+            end = start == -1 || args->range_last == ULLONG_MAX ? st.st_size
+                : scan_line_start(fd, start, args->range_first - 1, args->range_last, st.st_size);
+        }
+    }
+    else{
+        start = args->range_first - 1 < (unsigned long long) st.st_size ? (off_t) (args->range_first - 1) : st.st_size;
+        end = args->range_last < (unsigned long long) st.st_size ? (off_t) args->range_last : st.st_size;
+        off_t line_start = start;
+        if(start < st.st_size && indexed){
+            line_start = index_line_of_offset(&index, start);
+            indexed = line_start != -1; // a corrupt index is not used
+        }
+        if(start < st.st_size && !indexed){
+            line_start = scan_back_line_start(fd, start);
+        }
+        key_index = line_start == -1 ? 0 : (size_t) ((start - line_start) % table->key_length);
+        if(line_start == -1){
+            start = -1;
+        }
+    }
+
+    if(args->index_file != NULL){
+        close_line_index(&index);
+    }
+    if(start == -1 || end == -1){
+        usage("./vigenere: error occured while reading the input file.");
+    }
+
+    char *buffer = malloc(INPUT_BUFFER_SIZE);
+    if(buffer == NULL){
+        usage("./vigenere: error occured while allocating the input buffer.");
+    }
+    while(start < end){
+        size_t length = end - start < INPUT_BUFFER_SIZE ? (size_t) (end - start) : INPUT_BUFFER_SIZE;
+        if(read_region(fd, buffer, length, start) != (ssize_t) length){
+            flush_output(writer);
+            usage("./vigenere: error occured while reading the input file.");
+        }
+        key_index = cipher_to_output(table, buffer, length, key_index, writer, 0);
+        start += length;
+    }
+
+    free(buffer);
+    close(fd);
+}
+
+/**
+* Indexing a File
+* @brief Builds the line index of a file given with --index, unless it is up to date.
+*
+* @param file input file
+* @param index_file path of the index
+*/
+void index_input(char *file, char *index_file){
+    struct stat st;
+    line_index index;
+
+    int fd = open(file, O_RDONLY);
+    if(fd == -1){
+        usage("./viginere: Erorr occured while opening the input file.");
+    }
+    if(fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)){
+        usage("./vigenere: option --index needs a regular input file.");
+    }
+    ensure_line_index(&index, fd, &st, index_file);
+    close_line_index(&index);
+    close(fd);
+}
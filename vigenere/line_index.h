@@ -0,0 +1,21 @@
+/**
+ * @file line_index.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Line index of vigenere (--index, --lines and --bytes).
+ *
+ * @details The index of a file stores where its lines start, so a range of lines or bytes is (de)encrypted without
+ *          reading the file from the start.
+ **/
+
+#ifndef LINE_INDEX_H
+#define LINE_INDEX_H
+
+#include "vigenere.h"
+#include "output.h"
+
+void cipher_range(vigenere_table *table, char *file, arguments *args, output_writer *writer);
+void index_input(char *file, char *index_file);
+
+#endif
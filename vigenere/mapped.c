@@ -0,0 +1,214 @@
+/**
+ * @file mapped.c
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Memory-mapped I/O of vigenere (--io=mmap, -i and -o with several files).
+ **/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "vigenere.h"
+#include "mapped.h"
+#include "output.h"
+#include "stats.h"
+
+#define MAP_WINDOW_SIZE (64 << 20) // bytes of a file mapped at once (64 MiB)
+
+/**
+* Mapping a Window
+* @brief Maps length bytes of a file at any offset.
+* @details The mapping starts at the page boundary below offset, *mapping and *mapped_length describe it for munmap.
+*
+* @param fd file descriptor
+* @param offset file offset of the window
+* @param length number of bytes of the window
+* @param prot memory protection (PROT_READ, PROT_WRITE)
+* @param mapping set to the start of the mapping
+* @param mapped_length set to the length of the mapping
+* @return pointer to the byte at offset, NULL on error
+*/
+char *map_window(int fd, off_t offset, size_t length, int prot, void **mapping, size_t *mapped_length){
+    off_t page = sysconf(_SC_PAGESIZE);
+    off_t start = offset - offset % page;
+
+    *mapped_length = length + (offset - start);
+    double begin = stats_mode == STATS_OFF ? 0 : stats_clock();
+    *mapping = mmap(NULL, *mapped_length, prot, prot & PROT_WRITE ? MAP_SHARED : MAP_PRIVATE, fd, start);
+    if(*mapping == MAP_FAILED){
+        return NULL;
+    }
+    if(stats_mode != STATS_OFF){
+        stats_count(STATS_MAP, STATS_SYSCALL_MMAP, 0, begin);
+    }
+    madvise(*mapping, *mapped_length, MADV_SEQUENTIAL);
+    return (char *) *mapping + (offset - start);
+}
+
+/**
+* Ciphering a Mapped File
+* @brief (De)encrypts a regular file through a sliding memory mapping to the buffered output.
+* @details This removes the copy of read(); the file is mapped MAP_WINDOW_SIZE bytes at a time.
+*
+* @param table cipher table of the key
+* @param fd input file descriptor (regular file)
+* @param size size of the file
+* @param writer buffered output
+* @return 0 on success, -1 if mapping failed
+*/
+int cipher_mapped(vigenere_table *table, int fd, off_t size, output_writer *writer){
+    size_t index = 0;
+
+    for(off_t offset = 0; offset < size; offset += MAP_WINDOW_SIZE){
+        size_t length = size - offset < MAP_WINDOW_SIZE ? (size_t) (size - offset) : MAP_WINDOW_SIZE;
+        void *mapping;
+        size_t mapped_length;
+        char *window = map_window(fd, offset, length, PROT_READ, &mapping, &mapped_length);
+        if(window == NULL){
+            return -1;
+        }
+        index = cipher_to_output(table, window, length, index, writer, STATS_MAPPED_IN);
+        munmap(mapping, mapped_length);
+    }
+
+    return 0;
+}
+
+/**
+* Ciphering a File in Place
+* @brief (De)encrypts a regular file in place (-i) through a sliding shared memory mapping.
+*
+* @param table cipher table of the key
+* @param file file to be (de)encrypted
+*/
+void cipher_in_place(vigenere_table *table, char *file){
+    int fd = open(file, O_RDWR);
+    struct stat st;
+
+    if(fd == -1){
+        usage("./viginere: Erorr occured while opening the input file.");
+    }
+    if(fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)){
+        usage("./vigenere: option -i needs regular files.");
+    }
+
+    size_t index = 0;
+    for(off_t offset = 0; offset < st.st_size; offset += MAP_WINDOW_SIZE){
+        size_t length = st.st_size - offset < MAP_WINDOW_SIZE ? (size_t) (st.st_size - offset) : MAP_WINDOW_SIZE;
+        void *mapping;
+        size_t mapped_length;
+        char *window = map_window(fd, offset, length, PROT_READ | PROT_WRITE, &mapping, &mapped_length);
+        if(window == NULL){
+            usage("./vigenere: error occured while mapping the input file.");
+        }
+        index = stats_cipher_mapped(table, window, window, length, index, STATS_MAPPED_IN | STATS_MAPPED_OUT);
+        if(munmap(mapping, mapped_length) == -1){
+            usage("./vigenere: error occured while writing the input file.");
+        }
+    }
+
+    if(close(fd) == -1){
+        usage("./vigenere: error occured while writing the input file.");
+    }
+}
+
+/**
+* Ciphering Files to a Mapped Output
+* @brief (De)encrypts regular files directly from their mappings into the mapped output file (-o).
+* @details All inputs are opened first and sized by fstat() of these descriptors, so an input growing meanwhile
+*          cannot run past the output. The output space is reserved with posix_fallocate(), so a full disk is an
+*          error here instead of a SIGBUS on the mapping, and every output window is written back with
+*          msync(MS_SYNC) before it is unmapped, which reports write errors. This is only done if all inputs are
+*          regular files (not the output itself) and the output is (or becomes) a regular file that can be
+*          preallocated, otherwise nothing is done and the buffered write() path has to be used.
+*
+* @param table cipher table of the key
+* @param files input files
+* @param count number of input files
+* @param outfile output file
+* @return 1 if the files were (de)encrypted, 0 if the buffered path has to be used
+*/
+int cipher_files_mapped(vigenere_table *table, char **files, int count, char *outfile){
+    struct stat st;
+    struct stat out_st;
+    int out_exists = stat(outfile, &out_st) == 0;
+    int usable = !out_exists || S_ISREG(out_st.st_mode);
+    int *inputs = (int *) malloc(count * sizeof(int));
+    off_t *sizes = (off_t *) malloc(count * sizeof(off_t));
+    off_t total = 0;
+    int opened = 0;
+    int output = -1;
+
+    if(inputs == NULL || sizes == NULL){
+        usage("./vigenere: memory allocation failed.");
+    }
+    while(usable && opened < count){
+        int input = open(files[opened], O_RDONLY);
+        if(input == -1){ // the buffered path reports it
+            usable = 0;
+            break;
+        }
+        inputs[opened++] = input;
+        if(fstat(input, &st) == -1 || !S_ISREG(st.st_mode)
+           || (out_exists && st.st_dev == out_st.st_dev && st.st_ino == out_st.st_ino)){
+            usable = 0;
+            break;
+        }
+        sizes[opened - 1] = st.st_size;
+        total += st.st_size;
+    }
+
+    if(usable && total > 0){
+        output = open(outfile, O_RDWR | O_CREAT | O_TRUNC, 0666);
+        if(output == -1){
+            usage("./vigenere: error occured while opening the output file.");
+        }
+        if(posix_fallocate(output, 0, total) != 0){ // not supported or no space: write() reports it
+            ftruncate(output, 0);
+            close(output);
+            output = -1;
+        }
+    }
+
+    if(output != -1){
+        off_t out_offset = 0;
+        for(int i = 0; i < count; i++){
+            size_t index = 0;
+            for(off_t offset = 0; offset < sizes[i]; offset += MAP_WINDOW_SIZE){
+                size_t length = sizes[i] - offset < MAP_WINDOW_SIZE ? (size_t) (sizes[i] - offset) : MAP_WINDOW_SIZE;
+                void *in_mapping, *out_mapping;
+                size_t in_length, out_length;
+                char *in_window = map_window(inputs[i], offset, length, PROT_READ, &in_mapping, &in_length);
+                char *out_window = map_window(output, out_offset + offset, length, PROT_READ | PROT_WRITE, &out_mapping, &out_length);
+                if(in_window == NULL || out_window == NULL){
+                    usage("./vigenere: error occured while mapping a file.");
+                }
+                index = stats_cipher_mapped(table, in_window, out_window, length, index, STATS_MAPPED_IN | STATS_MAPPED_OUT);
+                munmap(in_mapping, in_length);
+                double start = stats_mode == STATS_OFF ? 0 : stats_clock();
+                if(msync(out_mapping, out_length, MS_SYNC) == -1){
+                    usage("./vigenere: error occured while writing the output.");
+                }
+                if(stats_mode != STATS_OFF){
+                    stats_count(STATS_MAP, STATS_SYSCALL_MSYNC, 0, start);
+                }
+                munmap(out_mapping, out_length);
+            }
+            out_offset += sizes[i];
+        }
+        if(close(output) == -1){
+            usage("./vigenere: error occured while closing the output file.");
+        }
+    }
+
+    for(int i = 0; i < opened; i++){
+        close(inputs[i]);
+    }
+    free(inputs);
+    free(sizes);
+    return output != -1;
+}
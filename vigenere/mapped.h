@@ -0,0 +1,25 @@
+/**
+ * @file mapped.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Memory-mapped I/O of vigenere (--io=mmap, -i and -o with several files).
+ *
+ * @details Regular files are (de)encrypted from mappings of MAP_WINDOW_SIZE bytes, into the output buffer, in place or
+ *          into a mapped output file.
+ **/
+
+#ifndef MAPPED_H
+#define MAPPED_H
+
+#include <sys/types.h>
+
+#include "libvigenere_internal.h"
+#include "output.h"
+
+char *map_window(int fd, off_t offset, size_t length, int prot, void **mapping, size_t *mapped_length);
+int cipher_mapped(vigenere_table *table, int fd, off_t size, output_writer *writer);
+void cipher_in_place(vigenere_table *table, char *file);
+int cipher_files_mapped(vigenere_table *table, char **files, int count, char *outfile);
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ * @file output.c
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Buffered output of vigenere.
+ **/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#include "vigenere.h"
+#include "output.h"
+#include "stats.h"
+
+/**
+* Opening Output
+* @brief Initializes the buffered output.
+* @details Allocates the aligned output buffer. The output file itself is opened on the first flush.
+*
+* @param writer output to be initialized
+* @param outfile output file, NULL for stdout
+*/
+void open_output(output_writer *writer, char *outfile){
+    writer->outfile = outfile;
+    writer->fd = outfile == NULL ? STDOUT_FILENO : -1;
+    writer->used = 0;
+
+    if(posix_memalign((void **) &writer->buffer, OUTPUT_BUFFER_ALIGNMENT, OUTPUT_BUFFER_SIZE) != 0){
+        usage("./vigenere: error occured while allocating the output buffer.");
+    }
+}
+
+/**
+* Output File Descriptor
+* @brief Returns the file descriptor of the output.
+* @details Opens (and truncates) the output file if nothing was written yet.
+*
+* @param writer buffered output
+* @return file descriptor
+*/
+int output_fd(output_writer *writer){
+    if(writer->fd == -1){
+        writer->fd = open(writer->outfile, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if(writer->fd == -1){
+            usage("./vigenere: error occured while opening the output file.");
+        }
+    }
+    return writer->fd;
+}
+
+/**
+* Writing to the Output File
+* @brief Writes bytes to the output file descriptor.
+* @details Partial writes are continued, on a failed write the program exits with EXIT_FAILURE.
+*
+* @param writer buffered output
+* @param data bytes to be written
+* @param length number of bytes
+*/
+void write_output_fd(output_writer *writer, const char *data, size_t length){
+    int fd = output_fd(writer);
+    size_t written = 0;
+    while(written < length){
+        ssize_t result = stats_write(fd, data + written, length - written);
+        if(result == -1){
+            if(errno == EINTR){
+                continue;
+            }
+            usage("./vigenere: error occured while writing the output.");
+        }
+        written += result;
+    }
+}
+
+/**
+* Flushing Output
+* @brief Writes all buffered bytes to the output.
+*
+* @param writer buffered output
+*/
+void flush_output(output_writer *writer){
+    if(writer->used == 0){
+        return;
+    }
+    write_output_fd(writer, writer->buffer, writer->used);
+    writer->used = 0;
+}
+
+/**
+* Writing Output
+* @brief Appends already (de)encrypted bytes to the output.
+* @details Small blocks are buffered, large blocks are written directly after flushing the buffer.
+*
+* @param writer buffered output
+* @param data bytes to be written
+* @param length number of bytes
+*/
+void write_output(output_writer *writer, const char *data, size_t length){
+    if(writer->used + length <= OUTPUT_BUFFER_SIZE){
+        memcpy(writer->buffer + writer->used, data, length);
+        writer->used += length;
+        return;
+    }
+    flush_output(writer);
+    write_output_fd(writer, data, length);
+}
+
+/**
+* Closing Output
+* @brief Flushes and closes the buffered output.
+* @details Closing errors of the output file (e.g. delayed write errors) exit with EXIT_FAILURE.
+*
+* @param writer buffered output
+*/
+void close_output(output_writer *writer){
+    flush_output(writer);
+    if(writer->outfile != NULL && writer->fd != -1 && close(writer->fd) == -1){
+        usage("./vigenere: error occured while closing the output file.");
+    }
+    writer->fd = -1;
+    free(writer->buffer);
+    writer->buffer = NULL;
+}
+
+/**
+* Ciphering to the Output
+* @brief (De)encrypts a block of bytes directly into the output buffer.
+*
+* @param table cipher table of the key
+* @param in input bytes
+* @param length number of bytes
+* @param index key index of the first byte
+* @param writer buffered output
+* @param mapped STATS_MAPPED_IN if in is a mapping, 0 otherwise
+* @return key index of the byte following the block
+*/
+size_t cipher_to_output(vigenere_table *table, const char *in, size_t length, size_t index, output_writer *writer,
+                        int mapped){
+    while(length > 0){
+        if(writer->used == OUTPUT_BUFFER_SIZE){
+            flush_output(writer);
+        }
+        size_t chunk = OUTPUT_BUFFER_SIZE - writer->used;
+        if(chunk > length){
+            chunk = length;
+        }
+        index = mapped ? stats_cipher_mapped(table, in, writer->buffer + writer->used, chunk, index, mapped)
+                       : stats_cipher(table, in, writer->buffer + writer->used, chunk, index);
+        writer->used += chunk;
+        in += chunk;
+        length -= chunk;
+    }
+    return index;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file output.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Buffered output of vigenere.
+ *
+ * @details The output file (or stdout) is written through one aligned buffer, blocks are (de)encrypted directly
+ *          into it.
+ **/
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+
+#include "libvigenere_internal.h"
+
+#define OUTPUT_BUFFER_SIZE (1 << 20) // size of the output buffer (1 MiB)
+#define OUTPUT_BUFFER_ALIGNMENT (4096) // alignment of the output buffer
+
+/**
+ * @struct output_writer
+ * @brief This structure represents the buffered output (outfile or stdout).
+ * @details The output file is opened once, on the first flush, so no file is created if nothing is written.
+ *          fd is -1 until then. buffer holds used bytes that have not been written yet.
+ */
+typedef struct{
+    char *outfile;
+    int fd;
+    char *buffer;
+    size_t used;
+} output_writer;
+
+void open_output(output_writer *writer, char *outfile);
+int output_fd(output_writer *writer);
+void write_output_fd(output_writer *writer, const char *data, size_t length);
+void flush_output(output_writer *writer);
+void write_output(output_writer *writer, const char *data, size_t length);
+void close_output(output_writer *writer);
+size_t cipher_to_output(vigenere_table *table, const char *in, size_t length, size_t index, output_writer *writer,
+                        int mapped);
+
+#endif
@@ -0,0 +1,598 @@
+/**
+ * @file parallel.c
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Multi-threaded (de)encryption of vigenere (-j).
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "vigenere.h"
+#include "parallel.h"
+#include "output.h"
+#include "stats.h"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#define MAX_CPUS (1024) // largest CPU number considered for pinning
+#define MAX_NUMA_NODES (64) // largest NUMA node number read from /sys/devices/system/node
+#define HUGE_PAGE_SIZE (2 << 20) // size of a huge page, REGION_SIZE is a multiple of it (2 MiB)
+#define STAGE_CHUNK_SIZE (1 << 20) // size of a staged chunk of a file processed by the pool (1 MiB)
+#define STAGE_CHUNKS (4) // maximal number of staged chunks per file in flight
+
+/**
+ * @struct cpu_topology
+ * @brief This structure represents the CPUs the process may run on, ordered by NUMA node.
+ * @details The CPUs of a node are consecutive in cpus, so workers given neighbouring entries share a node.
+ *          count is 0 if the CPUs are unknown.
+ */
+typedef struct{
+    int cpus[MAX_CPUS];
+    int count;
+} cpu_topology;
+
+/**
+* Parsing a CPU List
+* @brief Marks the CPUs of a list of the form 0-3,8,10-11 (as in /sys/devices/system/node/node*\/cpulist).
+*
+* @param text CPU list
+* @param set set[cpu] is set to 1 for every CPU of the list (MAX_CPUS entries)
+*/
+static void parse_cpulist(const char *text, unsigned char *set){
+    char *end;
+    while(isdigit((unsigned char) *text)){
+        long first = strtol(text, &end, 10);
+        long last = first;
+        if(*end == '-'){
+            last = strtol(end + 1, &end, 10);
+        }
+        for(long cpu = first; cpu <= last && cpu < MAX_CPUS; cpu++){
+            set[cpu] = 1;
+        }
+        text = *end == ',' ? end + 1 : end;
+    }
+}
+
+/**
+* Reading the Topology
+* @brief Lists the CPUs of the affinity mask of the process, node by node.
+* @details The nodes are read from /sys/devices/system/node; CPUs of no node (or without it, all CPUs) come last.
+*
+* @param topology set to the CPUs, count is 0 if the affinity mask cannot be read
+*/
+static void read_topology(cpu_topology *topology){
+    unsigned long mask[MAX_CPUS / (8 * sizeof(unsigned long))];
+    unsigned char allowed[MAX_CPUS];
+    unsigned char set[MAX_CPUS];
+
+    topology->count = 0;
+    memset(mask, 0, sizeof(mask));
+#ifdef __linux__
+    if(syscall(__NR_sched_getaffinity, 0, sizeof(mask), mask) == -1){
+        return;
+    }
+#else
+    return;
+#endif
+    for(int cpu = 0; cpu < MAX_CPUS; cpu++){
+        allowed[cpu] = (mask[cpu / (8 * sizeof(unsigned long))] >> (cpu % (8 * sizeof(unsigned long)))) & 1;
+    }
+
+    for(int node = 0; node < MAX_NUMA_NODES; node++){
+        char path[64];
+        char list[4096];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE *file = fopen(path, "r");
+        if(file == NULL){
+            continue;
+        }
+        if(fgets(list, sizeof(list), file) != NULL){
+            memset(set, 0, sizeof(set));
+            parse_cpulist(list, set);
+            for(int cpu = 0; cpu < MAX_CPUS; cpu++){
+                if(set[cpu] && allowed[cpu]){
+                    topology->cpus[topology->count++] = cpu;
+                    allowed[cpu] = 0;
+                }
+            }
+        }
+        fclose(file);
+    }
+
+    for(int cpu = 0; cpu < MAX_CPUS; cpu++){
+        if(allowed[cpu]){
+            topology->cpus[topology->count++] = cpu;
+        }
+    }
+}
+
+/**
+* Pinning a Thread
+* @brief Restricts the calling thread to one CPU. Failures are ignored, the thread then stays unpinned.
+*
+* @param cpu CPU, -1 to leave the thread unpinned
+*/
+static void pin_thread(int cpu){
+#ifdef __linux__
+    unsigned long mask[MAX_CPUS / (8 * sizeof(unsigned long))];
+    if(cpu < 0){
+        return;
+    }
+    memset(mask, 0, sizeof(mask));
+    mask[cpu / (8 * sizeof(unsigned long))] = 1UL << (cpu % (8 * sizeof(unsigned long)));
+    syscall(__NR_sched_setaffinity, 0, sizeof(mask), mask);
+#endif
+}
+
+/**
+* Allocating a Region Buffer
+* @brief Allocates a buffer from huge pages and touches it, so it is placed on the NUMA node of the calling thread.
+* @details Reserved huge pages (MAP_HUGETLB) are tried first, then transparent huge pages (MADV_HUGEPAGE) and small
+*          pages. Every page is written once by the caller (first touch), which is the thread that will use it.
+*
+* @param length size of the buffer (a multiple of HUGE_PAGE_SIZE)
+* @return buffer, to be freed with munmap(buffer, length)
+*/
+static char *alloc_region(size_t length){
+    char *buffer = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    buffer = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    if(buffer == MAP_FAILED){
+        buffer = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(buffer == MAP_FAILED){
+            usage("./vigenere: error occured while allocating the regions.");
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(buffer, length, MADV_HUGEPAGE);
+#endif
+    }
+
+    long page = sysconf(_SC_PAGESIZE);
+    for(size_t i = 0; i < length; i += page){
+        buffer[i] = 0;
+    }
+    return buffer;
+}
+
+/**
+ * @struct parallel_region
+ * @brief This structure represents one region of a file as handled by a worker thread.
+ * @details The worker (de)encrypts everything after the first \n of the region (where the key index is known to be 0).
+ *          prefix is the number of bytes before that \n, which still need the key index carried over from the previous
+ *          region; if the region contains no \n, prefix is its whole length. end_index is the key index after the
+ *          region (only valid if it contains a \n).
+ */
+typedef struct{
+    char *buffer;
+    size_t length;
+    size_t prefix;
+    size_t end_index;
+} parallel_region;
+
+/**
+ * @struct parallel_job
+ * @brief This structure represents a file (de)encrypted by several threads.
+ * @details The file is processed in rounds: in round r, worker w handles region r * threads + w. Every worker owns
+ *          two regions (double buffering), so the main thread writes round r while the workers read round r + 1.
+ *          round is the round to be processed next, finished counts the workers done with it.
+ */
+typedef struct{
+    vigenere_table *table;
+    int fd;
+    off_t size;
+    int threads;
+    long round;
+    int finished;
+    int error;
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    parallel_region (*regions)[2];
+} parallel_job;
+
+/**
+ * @struct parallel_worker
+ * @brief This structure represents the arguments of a worker thread.
+ * @details cpu is the CPU the worker is pinned to, -1 if it is not pinned.
+ */
+typedef struct{
+    parallel_job *job;
+    int id;
+    int cpu;
+} parallel_worker;
+
+/**
+* Reading a Region
+* @brief Reads length bytes at offset, continuing partial reads.
+*
+* @param fd input file descriptor
+* @param buffer destination
+* @param length number of bytes
+* @param offset file offset
+* @return number of bytes read, -1 on error
+*/
+ssize_t read_region(int fd, char *buffer, size_t length, off_t offset){
+    size_t done = 0;
+    while(done < length){
+        ssize_t result = stats_pread(fd, buffer + done, length - done, offset + done);
+        if(result == -1){
+            if(errno == EINTR){
+                continue;
+            }
+            return -1;
+        }
+        if(result == 0){
+            break;
+        }
+        done += result;
+    }
+    return done;
+}
+
+/**
+* Worker Thread
+* @brief Reads and (de)encrypts the regions of one worker, round after round.
+* @details The worker pins itself first and then allocates its two region buffers, so they are placed on its NUMA
+*          node. The main thread only uses them after the first round is done.
+*
+* @param argument parallel_worker
+* @return NULL
+*/
+static void *parallel_worker_thread(void *argument){
+    parallel_worker *worker = argument;
+    parallel_job *job = worker->job;
+    long rounds = (job->size + (off_t) job->threads * REGION_SIZE - 1) / ((off_t) job->threads * REGION_SIZE);
+
+    pin_thread(worker->cpu);
+    job->regions[worker->id][0].buffer = alloc_region(REGION_SIZE);
+    job->regions[worker->id][1].buffer = alloc_region(REGION_SIZE);
+
+    for(long round = 0; round < rounds; round++){
+        pthread_mutex_lock(&job->lock);
+        while(job->round < round){
+            pthread_cond_wait(&job->start, &job->lock);
+        }
+        pthread_mutex_unlock(&job->lock);
+
+        parallel_region *region = &job->regions[worker->id][round % 2];
+        off_t offset = ((off_t) round * job->threads + worker->id) * REGION_SIZE;
+        ssize_t length = 0;
+        if(offset < job->size){
+            length = read_region(job->fd, region->buffer, REGION_SIZE, offset);
+        }
+
+        if(length > 0){
+            region->length = length;
+            char *newline = memchr(region->buffer, '\n', length);
+            region->prefix = newline == NULL ? (size_t) length : (size_t) (newline - region->buffer);
+            if(newline != NULL){
+                region->end_index = stats_cipher(job->table, newline, newline, length - region->prefix, 0);
+            }
+        }
+        else{
+            region->length = 0;
+            region->prefix = 0;
+        }
+
+        pthread_mutex_lock(&job->lock);
+        if(length == -1){
+            job->error = 1;
+        }
+        if(++job->finished == job->threads){
+            pthread_cond_signal(&job->done);
+        }
+        pthread_mutex_unlock(&job->lock);
+    }
+
+    return NULL;
+}
+
+/**
+* Ciphering in Parallel
+* @brief (De)encrypts a regular file with several threads, writing the output in order.
+* @details The output is byte for byte the same as of cipher_stream: the workers (de)encrypt their regions from the
+*          first \n on, the main thread then (de)encrypts the prefixes in file order with the carried key index and writes
+*          the regions.
+*          If there are enough CPUs, the workers are pinned, spread evenly over the CPUs in node order: workers with
+*          neighbouring ids, and thus neighbouring regions of a round, share a NUMA node, and each worker transforms its
+*          regions in huge page buffers on its own node.
+*
+* @param table cipher table of the key
+* @param fd input file descriptor (regular file)
+* @param size size of the file
+* @param threads number of threads
+* @param writer buffered output
+* @return 0 on success, -1 on a read error
+*/
+int cipher_parallel(vigenere_table *table, int fd, off_t size, int threads, output_writer *writer){
+    parallel_job job;
+    parallel_worker workers[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+
+    job.table = table;
+    job.fd = fd;
+    job.size = size;
+    job.threads = threads;
+    job.round = 0;
+    job.finished = 0;
+    job.error = 0;
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.start, NULL);
+    pthread_cond_init(&job.done, NULL);
+
+    job.regions = calloc(threads, sizeof(*job.regions));
+    if(job.regions == NULL){
+        usage("./vigenere: error occured while allocating the regions.");
+    }
+
+    cpu_topology *topology = malloc(sizeof(cpu_topology));
+    if(topology == NULL){
+        usage("./vigenere: error occured while allocating the regions.");
+    }
+    read_topology(topology);
+
+    for(int i = 0; i < threads; i++){
+        workers[i].job = &job;
+        workers[i].id = i;
+        workers[i].cpu = threads <= topology->count ? topology->cpus[(long) i * topology->count / threads] : -1;
+        if(pthread_create(&ids[i], NULL, parallel_worker_thread, &workers[i]) != 0){
+            usage("./vigenere: error occured while creating a thread.");
+        }
+    }
+
+    long rounds = (size + (off_t) threads * REGION_SIZE - 1) / ((off_t) threads * REGION_SIZE);
+    size_t index = 0;
+
+    for(long round = 0; round < rounds; round++){
+        pthread_mutex_lock(&job.lock);
+        while(job.finished < threads){
+            pthread_cond_wait(&job.done, &job.lock);
+        }
+        job.finished = 0;
+        job.round = round + 1;
+        pthread_cond_broadcast(&job.start);
+        pthread_mutex_unlock(&job.lock);
+
+        for(int i = 0; i < threads && !job.error; i++){
+            parallel_region *region = &job.regions[i][round % 2];
+            size_t prefix_index = stats_cipher(table, region->buffer, region->buffer, region->prefix, index);
+            index = region->prefix == region->length ? prefix_index : region->end_index;
+            write_output(writer, region->buffer, region->length);
+        }
+    }
+
+    for(int i = 0; i < threads; i++){
+        pthread_join(ids[i], NULL);
+    }
+    for(int i = 0; i < threads; i++){
+        munmap(job.regions[i][0].buffer, REGION_SIZE);
+        munmap(job.regions[i][1].buffer, REGION_SIZE);
+    }
+    free(job.regions);
+    free(topology);
+    pthread_mutex_destroy(&job.lock);
+    pthread_cond_destroy(&job.start);
+    pthread_cond_destroy(&job.done);
+
+    return job.error ? -1 : 0;
+}
+
+/**
+ * @struct staged_file
+ * @brief This structure represents a file being (de)encrypted by a pool worker, staged for the output.
+ * @details chunks is a ring of STAGE_CHUNKS (de)encrypted chunks: head is the next chunk to be written, count the number
+ *          of filled chunks. file is the argv index of the file, -1 if the slot is free. done is set after the last chunk,
+ *          error to the message to be printed when the file is reached in the output.
+ */
+typedef struct{
+    int file;
+    char *chunks[STAGE_CHUNKS];
+    size_t lengths[STAGE_CHUNKS];
+    int head;
+    int count;
+    int done;
+    char *error;
+} staged_file;
+
+/**
+ * @struct file_pool
+ * @brief This structure represents the worker pool (de)encrypting several files at once.
+ * @details The file i is staged in slot i % slots, so at most slots files are in flight and at most
+ *          slots * STAGE_CHUNKS * STAGE_CHUNK_SIZE bytes are staged. next_file is the next file to be taken by a
+ *          worker, emitted the next file to be written by the main thread.
+ */
+typedef struct{
+    vigenere_table *table;
+    char **files;
+    int count;
+    int slots;
+    int next_file;
+    int emitted;
+    staged_file *staged;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} file_pool;
+
+/**
+* Pool Worker Thread
+* @brief Takes files in argument order and (de)encrypts them chunk by chunk into their slot.
+* @details A worker blocks while the slot of its next file is still in use or its chunk ring is full.
+*
+* @param argument file_pool
+* @return NULL
+*/
+static void *file_pool_thread(void *argument){
+    file_pool *pool = argument;
+
+    pthread_mutex_lock(&pool->lock);
+    while(pool->next_file < pool->count){
+        int file = pool->next_file;
+        staged_file *slot = &pool->staged[file % pool->slots];
+
+        if(file >= pool->emitted + pool->slots){
+            pthread_cond_wait(&pool->changed, &pool->lock);
+            continue;
+        }
+        pool->next_file++;
+        slot->file = file;
+        pthread_mutex_unlock(&pool->lock);
+
+        char *error = NULL;
+        int fd = open(pool->files[file], O_RDONLY);
+        if(fd == -1){
+            error = "./viginere: Erorr occured while opening the input file.";
+        }
+
+        size_t index = 0;
+        while(error == NULL){
+            pthread_mutex_lock(&pool->lock);
+            while(slot->count == STAGE_CHUNKS){
+                pthread_cond_wait(&pool->changed, &pool->lock);
+            }
+            int chunk = (slot->head + slot->count) % STAGE_CHUNKS;
+            pthread_mutex_unlock(&pool->lock);
+
+            size_t length = 0;
+            while(length < STAGE_CHUNK_SIZE){
+                ssize_t result = stats_read(fd, slot->chunks[chunk] + length, STAGE_CHUNK_SIZE - length);
+                if(result == -1 && errno == EINTR){
+                    continue;
+                }
+                if(result == -1){
+                    error = "./vigenere: error occured while reading the input file.";
+                }
+                if(result <= 0){
+                    break;
+                }
+                length += result;
+            }
+            if(length == 0){
+                break;
+            }
+            index = stats_cipher(pool->table, slot->chunks[chunk], slot->chunks[chunk], length, index);
+
+            pthread_mutex_lock(&pool->lock);
+            slot->lengths[chunk] = length;
+            slot->count++;
+            pthread_cond_broadcast(&pool->changed);
+            pthread_mutex_unlock(&pool->lock);
+        }
+        if(fd != -1){
+            close(fd);
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        slot->error = error;
+        slot->done = 1;
+        pthread_cond_broadcast(&pool->changed);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+/**
+* Ciphering Files in Parallel
+* @brief (De)encrypts several files with a pool of threads, writing them in argument order.
+* @details The output is byte for byte the same as (de)encrypting the files one after another. Errors are reported
+*          when the failing file is reached, after all previous files have been written.
+*
+* @param table cipher table of the key
+* @param files input files
+* @param count number of input files
+* @param threads number of threads
+* @param writer buffered output
+*/
+void cipher_files_parallel(vigenere_table *table, char **files, int count, int threads, output_writer *writer){
+    file_pool pool;
+    pthread_t ids[MAX_THREADS];
+
+    if(threads > count){
+        threads = count;
+    }
+
+    pool.table = table;
+    pool.files = files;
+    pool.count = count;
+    pool.slots = 2 * threads;
+    pool.next_file = 0;
+    pool.emitted = 0;
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.changed, NULL);
+
+    pool.staged = calloc(pool.slots, sizeof(staged_file));
+    if(pool.staged == NULL){
+        usage("./vigenere: error occured while allocating the staging buffers.");
+    }
+    for(int i = 0; i < pool.slots; i++){
+        pool.staged[i].file = -1;
+        for(int j = 0; j < STAGE_CHUNKS; j++){
+            pool.staged[i].chunks[j] = malloc(STAGE_CHUNK_SIZE);
+            if(pool.staged[i].chunks[j] == NULL){
+                usage("./vigenere: error occured while allocating the staging buffers.");
+            }
+        }
+    }
+
+    for(int i = 0; i < threads; i++){
+        if(pthread_create(&ids[i], NULL, file_pool_thread, &pool) != 0){
+            usage("./vigenere: error occured while creating a thread.");
+        }
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    while(pool.emitted < count){
+        staged_file *slot = &pool.staged[pool.emitted % pool.slots];
+
+        if(slot->file != pool.emitted || (slot->count == 0 && !slot->done)){
+            pthread_cond_wait(&pool.changed, &pool.lock);
+            continue;
+        }
+
+        if(slot->count > 0){
+            int chunk = slot->head;
+            pthread_mutex_unlock(&pool.lock);
+            write_output(writer, slot->chunks[chunk], slot->lengths[chunk]);
+            pthread_mutex_lock(&pool.lock);
+            slot->head = (slot->head + 1) % STAGE_CHUNKS;
+            slot->count--;
+            pthread_cond_broadcast(&pool.changed);
+            continue;
+        }
+
+        if(slot->error != NULL){
+            flush_output(writer);
+            usage(slot->error);
+        }
+        slot->file = -1;
+        slot->head = 0;
+        slot->done = 0;
+        pool.emitted++;
+        pthread_cond_broadcast(&pool.changed);
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    for(int i = 0; i < threads; i++){
+        pthread_join(ids[i], NULL);
+    }
+    for(int i = 0; i < pool.slots; i++){
+        for(int j = 0; j < STAGE_CHUNKS; j++){
+            free(pool.staged[i].chunks[j]);
+        }
+    }
+    free(pool.staged);
+    pthread_mutex_destroy(&pool.lock);
+    pthread_cond_destroy(&pool.changed);
+}
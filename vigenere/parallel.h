@@ -0,0 +1,24 @@
+/**
+ * @file parallel.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Multi-threaded (de)encryption of vigenere (-j).
+ *
+ * @details A large file is split into regions (de)encrypted by worker threads pinned by NUMA node, several files are
+ *          (de)encrypted by a pool of workers at once. The output is the same as with one thread.
+ **/
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <sys/types.h>
+
+#include "libvigenere_internal.h"
+#include "output.h"
+
+ssize_t read_region(int fd, char *buffer, size_t length, off_t offset);
+int cipher_parallel(vigenere_table *table, int fd, off_t size, int threads, output_writer *writer);
+void cipher_files_parallel(vigenere_table *table, char **files, int count, int threads, output_writer *writer);
+
+#endif
@@ -0,0 +1,219 @@
+/**
+ * @file pipeline.c
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Reader/cipher/writer pipeline of vigenere (pipes, stdin and --io=pipeline).
+ **/
+
+#include <stdlib.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "vigenere.h"
+#include "pipeline.h"
+#include "output.h"
+#include "stats.h"
+
+#define PIPELINE_BLOCK_SIZE (1 << 20) // size of a slot of the reader/cipher/writer pipeline (1 MiB)
+#define PIPELINE_SLOTS (4) // number of slots of the pipeline ring
+#define PIPELINE_SPINS (1000) // polls of a pipeline counter before sleeping
+
+/**
+ * @struct pipeline_slot
+ * @brief This structure represents one buffer of the pipeline ring.
+ * @details length is the number of bytes read into buffer, 0 at EOF and -1 on a read error.
+ */
+typedef struct{
+    char *buffer;
+    ssize_t length;
+} pipeline_slot;
+
+/**
+ * @struct pipeline
+ * @brief This structure represents a stream (de)encrypted by a reader thread, the cipher stage and a writer thread.
+ * @details Slot n of the stream lives in slots[n % PIPELINE_SLOTS]. read, ciphered and written count the slots done by
+ *          each stage; every counter is advanced by its stage only, so the rings between the stages are single-producer,
+ *          single-consumer and need no lock. A stage only takes the lock to sleep when its ring is empty (or full for the
+ *          reader); sleepers tells the other stages that a wake-up is needed.
+ */
+typedef struct{
+    vigenere_table *table;
+    int fd;
+    output_writer *writer;
+    pipeline_slot slots[PIPELINE_SLOTS];
+    unsigned long read;
+    unsigned long ciphered;
+    unsigned long written;
+    int sleepers;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} pipeline;
+
+/**
+* Publishing a Pipeline Counter
+* @brief Advances the counter of a stage and wakes the sleeping stages.
+*
+* @param line pipeline
+* @param counter counter of the stage
+* @param value new value of the counter
+*/
+static void pipeline_publish(pipeline *line, unsigned long *counter, unsigned long value){
+    __atomic_store_n(counter, value, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&line->sleepers, __ATOMIC_SEQ_CST) > 0){
+        pthread_mutex_lock(&line->lock);
+        pthread_cond_broadcast(&line->wake);
+        pthread_mutex_unlock(&line->lock);
+    }
+}
+
+/**
+* Waiting for a Pipeline Counter
+* @brief Waits until the counter of another stage reaches target.
+* @details Spins PIPELINE_SPINS times before sleeping on the condition variable.
+*
+* @param line pipeline
+* @param counter counter of the other stage
+* @param target value to wait for
+*/
+static void pipeline_wait(pipeline *line, unsigned long *counter, unsigned long target){
+    for(int spin = 0; spin < PIPELINE_SPINS; spin++){
+        if(__atomic_load_n(counter, __ATOMIC_ACQUIRE) >= target){
+            return;
+        }
+    }
+
+    pthread_mutex_lock(&line->lock);
+    __atomic_add_fetch(&line->sleepers, 1, __ATOMIC_SEQ_CST);
+    while(__atomic_load_n(counter, __ATOMIC_SEQ_CST) < target){
+        pthread_cond_wait(&line->wake, &line->lock);
+    }
+    __atomic_sub_fetch(&line->sleepers, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&line->lock);
+}
+
+/**
+* Pipeline Reader Thread
+* @brief Reads the input block by block into free slots until EOF or a read error.
+*
+* @param argument pipeline
+* @return NULL
+*/
+static void *pipeline_reader_thread(void *argument){
+    pipeline *line = argument;
+
+    for(unsigned long n = 0; ; n++){
+        if(n >= PIPELINE_SLOTS){
+            pipeline_wait(line, &line->written, n + 1 - PIPELINE_SLOTS);
+        }
+
+        pipeline_slot *slot = &line->slots[n % PIPELINE_SLOTS];
+        ssize_t length;
+        do{
+            length = stats_read(line->fd, slot->buffer, PIPELINE_BLOCK_SIZE);
+        } while(length == -1 && errno == EINTR);
+        slot->length = length;
+
+        pipeline_publish(line, &line->read, n + 1);
+        if(length <= 0){
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+* Pipeline Writer Thread
+* @brief Writes the (de)encrypted slots in order, directly from the slot buffers.
+*
+* @param argument pipeline
+* @return NULL
+*/
+static void *pipeline_writer_thread(void *argument){
+    pipeline *line = argument;
+
+    for(unsigned long n = 0; ; n++){
+        pipeline_wait(line, &line->ciphered, n + 1);
+
+        pipeline_slot *slot = &line->slots[n % PIPELINE_SLOTS];
+        if(slot->length <= 0){
+            break;
+        }
+        write_output_fd(line->writer, slot->buffer, slot->length);
+
+        pipeline_publish(line, &line->written, n + 1);
+    }
+
+    return NULL;
+}
+
+/**
+* Ciphering a Stream in a Pipeline
+* @brief Reads, (de)encrypts and writes a file descriptor in three overlapping stages until EOF.
+* @details A reader thread fills the PIPELINE_SLOTS buffers, the calling thread (de)encrypts them in place and a writer
+*          thread writes them, so a slow input or output does not stall the other stages. Memory use is fixed at
+*          PIPELINE_SLOTS * PIPELINE_BLOCK_SIZE. The output buffer is flushed first, the writer is not used in between.
+*
+* @param table cipher table of the key
+* @param fd input file descriptor
+* @param writer buffered output
+* @return 0 on success, -1 on a read error
+*/
+int cipher_pipeline(vigenere_table *table, int fd, output_writer *writer){
+    pipeline line;
+    pthread_t reader;
+    pthread_t writer_id;
+    char *buffers;
+
+    if(posix_memalign((void **) &buffers, OUTPUT_BUFFER_ALIGNMENT, (size_t) PIPELINE_SLOTS * PIPELINE_BLOCK_SIZE) != 0){
+        usage("./vigenere: error occured while allocating the pipeline buffers.");
+    }
+
+    line.table = table;
+    line.fd = fd;
+    line.writer = writer;
+    for(int i = 0; i < PIPELINE_SLOTS; i++){
+        line.slots[i].buffer = buffers + (size_t) i * PIPELINE_BLOCK_SIZE;
+        line.slots[i].length = 0;
+    }
+    line.read = 0;
+    line.ciphered = 0;
+    line.written = 0;
+    line.sleepers = 0;
+    pthread_mutex_init(&line.lock, NULL);
+    pthread_cond_init(&line.wake, NULL);
+
+    flush_output(writer);
+
+    if(pthread_create(&reader, NULL, pipeline_reader_thread, &line) != 0 ||
+       pthread_create(&writer_id, NULL, pipeline_writer_thread, &line) != 0){
+        usage("./vigenere: error occured while creating a thread.");
+    }
+
+    size_t index = 0;
+    int error = 0;
+    for(unsigned long n = 0; ; n++){
+        pipeline_wait(&line, &line.read, n + 1);
+
+        pipeline_slot *slot = &line.slots[n % PIPELINE_SLOTS];
+        ssize_t length = slot->length;
+        if(length > 0){
+            index = stats_cipher(table, slot->buffer, slot->buffer, length, index);
+        }
+        error = length == -1;
+
+        pipeline_publish(&line, &line.ciphered, n + 1); // the slot may be reused from here on
+        if(length <= 0){
+            break;
+        }
+    }
+
+    pthread_join(reader, NULL);
+    pthread_join(writer_id, NULL);
+    pthread_mutex_destroy(&line.lock);
+    pthread_cond_destroy(&line.wake);
+    free(buffers);
+
+    return error ? -1 : 0;
+}
@@ -0,0 +1,20 @@
+/**
+ * @file pipeline.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Reader/cipher/writer pipeline of vigenere (pipes, stdin and --io=pipeline).
+ *
+ * @details A reader thread, the cipher stage and a writer thread hand blocks through a ring, so reading, (de)encrypting
+ *          and writing overlap.
+ **/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "libvigenere_internal.h"
+#include "output.h"
+
+int cipher_pipeline(vigenere_table *table, int fd, output_writer *writer);
+
+#endif
@@ -0,0 +1,146 @@
+/**
+ * @file splice.c
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief vmsplice engine of vigenere (--io=splice).
+ **/
+
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+#include "vigenere.h"
+#include "splice.h"
+#include "output.h"
+#include "stats.h"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#ifndef F_SETPIPE_SZ
+#define F_SETPIPE_SZ (1031)
+#define F_GETPIPE_SZ (1032)
+#endif
+#ifndef SPLICE_F_GIFT
+#define SPLICE_F_GIFT (8)
+#endif
+#endif
+
+#define SPLICE_BUFFER_SIZE (1 << 20) // requested size of the stdout pipe for vmsplice (1 MiB)
+
+/**
+* Filling a Buffer
+* @brief Reads from a file descriptor until the buffer is full or EOF is reached.
+*
+* @param fd input file descriptor
+* @param buffer destination
+* @param length size of the buffer
+* @return number of bytes read, -1 on error
+*/
+ssize_t fill_buffer(int fd, char *buffer, size_t length){
+    size_t done = 0;
+    while(done < length){
+        ssize_t result = stats_read(fd, buffer + done, length - done);
+        if(result == -1 && errno == EINTR){
+            continue;
+        }
+        if(result == -1){
+            return -1;
+        }
+        if(result == 0){
+            break;
+        }
+        done += result;
+    }
+    return done;
+}
+
+#ifdef __linux__
+
+
+/**
+* Ciphering a Pipe Stream
+* @brief (De)encrypts stdin into a stdout pipe, handing the pages to the pipe with vmsplice instead of copying them.
+* @details Only used with --io=splice. The pipe is resized to SPLICE_BUFFER_SIZE and every block of the pipe size gets
+*          a fresh anonymous mapping, which is gifted to the pipe (SPLICE_F_GIFT) and unmapped, never reused: the pipe
+*          only references the pages, and a reader that splices them onward (instead of copying them out) would see a
+*          reused buffer overwritten by the next block. stdin is read block by block, as splice cannot (de)encrypt.
+*          If vmsplice is not supported, the blocks are written to the output instead.
+*
+* @param table cipher table of the key
+* @param writer buffered output (stdout)
+* @return 0 on success, -1 on a read error, 1 if stdout is not a pipe
+*/
+int cipher_splice(vigenere_table *table, output_writer *writer){
+    struct stat st;
+    if(writer->outfile != NULL || fstat(STDOUT_FILENO, &st) == -1 || !S_ISFIFO(st.st_mode)){
+        return 1;
+    }
+
+    fcntl(STDOUT_FILENO, F_SETPIPE_SZ, SPLICE_BUFFER_SIZE);
+    int pipe_size = fcntl(STDOUT_FILENO, F_GETPIPE_SZ);
+    if(pipe_size <= 0){
+        return 1;
+    }
+
+    size_t index = 0;
+    int use_write = 0;
+    ssize_t length;
+
+    for(;;){
+        char *buffer = mmap(NULL, pipe_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(buffer == MAP_FAILED){
+            usage("./vigenere: error occured while allocating the splice buffers.");
+        }
+        length = fill_buffer(STDIN_FILENO, buffer, pipe_size);
+        if(length <= 0){
+            munmap(buffer, pipe_size);
+            break;
+        }
+        index = stats_cipher(table, buffer, buffer, length, index);
+
+        struct iovec vector = {buffer, (size_t) length};
+        while(!use_write && vector.iov_len > 0){
+            double start = stats_mode == STATS_OFF ? 0 : stats_clock();
+            ssize_t result = syscall(__NR_vmsplice, STDOUT_FILENO, &vector, 1, SPLICE_F_GIFT);
+            if(stats_mode != STATS_OFF){
+                stats_count(STATS_WRITE, STATS_SYSCALL_VMSPLICE, result > 0 ? result : 0, start);
+            }
+            if(result == -1 && errno == EINTR){
+                continue;
+            }
+            if(result == -1 && (errno == EINVAL || errno == ENOSYS)){
+                use_write = 1;
+                break;
+            }
+            if(result == -1){
+                usage("./vigenere: error occured while writing the output.");
+            }
+            vector.iov_base = (char *) vector.iov_base + result;
+            vector.iov_len -= result;
+        }
+        if(use_write){
+            write_output_fd(writer, vector.iov_base, vector.iov_len);
+        }
+        munmap(buffer, pipe_size); // the pipe keeps its own references to the spliced pages
+    }
+
+    return length == -1 ? -1 : 0;
+}
+
+#else
+
+/**
+* Ciphering a Pipe Stream
+* @brief vmsplice is not available on this platform.
+*
+* @return 1
+*/
+int cipher_splice(vigenere_table *table, output_writer *writer){
+    return 1;
+}
+
+#endif
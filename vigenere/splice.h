@@ -0,0 +1,23 @@
+/**
+ * @file splice.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief vmsplice engine of vigenere (--io=splice).
+ *
+ * @details stdin is (de)encrypted into pages that are handed to a stdout pipe with vmsplice instead of being copied.
+ *          cipher_splice returns 1 where vmsplice is not available.
+ **/
+
+#ifndef SPLICE_H
+#define SPLICE_H
+
+#include <sys/types.h>
+
+#include "libvigenere_internal.h"
+#include "output.h"
+
+ssize_t fill_buffer(int fd, char *buffer, size_t length);
+int cipher_splice(vigenere_table *table, output_writer *writer);
+
+#endif
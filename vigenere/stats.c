@@ -0,0 +1,327 @@
+/**
+ * @file stats.c
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief --stats of vigenere.
+ *
+ * @details The counters of a thread are allocated when it counts for the first time, print_stats runs at exit.
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include "vigenere.h"
+#include "stats.h"
+
+#define STATS_MIN_SECONDS (1e-3) // shortest phase time a GB/s rate is printed for
+#define STATS_BYTES(byte) (0x0101010101010101ULL * (byte)) // byte repeated in every byte of a word
+
+int stats_mode = STATS_OFF;
+static double stats_start;
+static __thread stats_counters *stats_thread_counters;
+static stats_counters *stats_threads;
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+* Stats Clock
+* @brief Returns the monotonic time in seconds.
+*
+* @return seconds
+*/
+double stats_clock(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+* Counters of the Thread
+* @brief Returns the --stats counters of the calling thread, allocating and registering them on first use.
+*
+* @return counters of the thread
+*/
+stats_counters *stats_thread(void){
+    if(stats_thread_counters == NULL){
+        stats_thread_counters = calloc(1, sizeof(stats_counters));
+        if(stats_thread_counters == NULL){
+            usage("./vigenere: error occured while allocating the stats counters.");
+        }
+        pthread_mutex_lock(&stats_lock);
+        stats_thread_counters->next = stats_threads;
+        stats_threads = stats_thread_counters;
+        pthread_mutex_unlock(&stats_lock);
+    }
+    return stats_thread_counters;
+}
+
+/**
+* Counting a Phase
+* @brief Adds bytes, time and a syscall of a phase to the counters of the calling thread.
+*
+* @param phase STATS_READ, STATS_MAP, STATS_TRANSFORM or STATS_WRITE
+* @param syscall STATS_SYSCALL_*, -1 if no syscall was made
+* @param bytes number of bytes
+* @param start stats_clock() when the phase began
+*/
+void stats_count(int phase, int syscall, size_t bytes, double start){
+    stats_counters *counters = stats_thread();
+    counters->bytes[phase] += bytes;
+    counters->seconds[phase] += stats_clock() - start;
+    if(syscall != -1){
+        counters->syscalls[syscall]++;
+    }
+}
+
+/**
+* Counted read
+* @brief read() that is counted as read phase with --stats.
+*
+* @param fd file descriptor
+* @param buffer destination
+* @param length size of the buffer
+* @return result of read()
+*/
+ssize_t stats_read(int fd, void *buffer, size_t length){
+    if(stats_mode == STATS_OFF){
+        return read(fd, buffer, length);
+    }
+    double start = stats_clock();
+    ssize_t result = read(fd, buffer, length);
+    stats_count(STATS_READ, STATS_SYSCALL_READ, result > 0 ? result : 0, start);
+    return result;
+}
+
+/**
+* Counted pread
+* @brief pread() that is counted as read phase with --stats.
+*
+* @param fd file descriptor
+* @param buffer destination
+* @param length size of the buffer
+* @param offset file offset
+* @return result of pread()
+*/
+ssize_t stats_pread(int fd, void *buffer, size_t length, off_t offset){
+    if(stats_mode == STATS_OFF){
+        return pread(fd, buffer, length, offset);
+    }
+    double start = stats_clock();
+    ssize_t result = pread(fd, buffer, length, offset);
+    stats_count(STATS_READ, STATS_SYSCALL_READ, result > 0 ? result : 0, start);
+    return result;
+}
+
+/**
+* Counted write
+* @brief write() that is counted as write phase with --stats.
+*
+* @param fd file descriptor
+* @param data bytes to be written
+* @param length number of bytes
+* @return result of write()
+*/
+ssize_t stats_write(int fd, const void *data, size_t length){
+    if(stats_mode == STATS_OFF){
+        return write(fd, data, length);
+    }
+    double start = stats_clock();
+    ssize_t result = write(fd, data, length);
+    stats_count(STATS_WRITE, STATS_SYSCALL_WRITE, result > 0 ? result : 0, start);
+    return result;
+}
+
+/**
+* Counting Text
+* @brief Adds the lines and letters of a block to the counters of the thread.
+* @details They are counted 8 bytes at a time with bit tricks, so the counting costs far less than the cipher.
+*
+* @param in input bytes
+* @param length number of bytes
+* @param outputs number of outputs the block is (de)encrypted to (the keys of --keys)
+*/
+void stats_text(const char *in, size_t length, size_t outputs){
+    unsigned long long lines = 0, letters = 0;
+    size_t i = 0;
+    for(; i + 8 <= length; i += 8){
+        uint64_t word, newlines, lower, high;
+        memcpy(&word, in + i, 8);
+        newlines = word ^ STATS_BYTES(0x0A);
+        newlines = ~(((newlines & STATS_BYTES(0x7F)) + STATS_BYTES(0x7F)) | newlines) & STATS_BYTES(0x80);
+        word |= STATS_BYTES(0x20);
+        lower = (word & STATS_BYTES(0x7F)) + STATS_BYTES(0x80 - 'a');
+        high = (word & STATS_BYTES(0x7F)) + STATS_BYTES(0x80 - 'z' - 1);
+        lines += ((newlines >> 7) * STATS_BYTES(1)) >> 56;
+        letters += (((lower & ~high & ~word & STATS_BYTES(0x80)) >> 7) * STATS_BYTES(1)) >> 56;
+    }
+    for(; i < length; i++){
+        unsigned char c = in[i];
+        lines += c == '\n';
+        letters += (unsigned char) ((c | 32) - 'a') < 26;
+    }
+
+    stats_counters *counters = stats_thread();
+    counters->lines += lines * outputs;
+    counters->letters += letters * outputs;
+}
+
+/**
+* Counted Cipher
+* @brief vigenere_cipher_block() that is counted as transform phase with --stats.
+* @details The lines and letters are counted before the block is (de)encrypted, as in and out may be the same.
+*
+* @param table cipher table of the key
+* @param in input bytes
+* @param out output bytes
+* @param length number of bytes
+* @param index key index of the first byte
+* @return key index of the byte following the block
+*/
+size_t stats_cipher(vigenere_table *table, const char *in, char *out, size_t length, size_t index){
+    if(stats_mode == STATS_OFF){
+        return vigenere_cipher_block(table, in, out, length, index);
+    }
+    double start = stats_clock();
+    stats_text(in, length, 1);
+    index = vigenere_cipher_block(table, in, out, length, index);
+    stats_count(STATS_TRANSFORM, -1, length, start);
+    return index;
+}
+
+/**
+* Counted Cipher over Mappings
+* @brief vigenere_cipher_block() on mapped memory that is counted as map phase with --stats.
+* @details The page faults (reading the file) and the copies into the page cache happen during the (de)encryption
+*          and cannot be told apart from it, so the whole pass is counted as map phase. The transform phase only
+*          gets the bytes, without time.
+*
+* @param table cipher table of the key
+* @param in input bytes
+* @param out output bytes
+* @param length number of bytes
+* @param index key index of the first byte
+* @param mapped STATS_MAPPED_IN and/or STATS_MAPPED_OUT
+* @return key index of the byte following the block
+*/
+size_t stats_cipher_mapped(vigenere_table *table, const char *in, char *out, size_t length, size_t index, int mapped){
+    if(stats_mode == STATS_OFF){
+        return vigenere_cipher_block(table, in, out, length, index);
+    }
+    double start = stats_clock();
+    stats_text(in, length, 1);
+    index = vigenere_cipher_block(table, in, out, length, index);
+    stats_count(STATS_MAP, -1, length, start);
+
+    stats_counters *counters = stats_thread();
+    counters->bytes[STATS_TRANSFORM] += length;
+    counters->mapped_in += mapped & STATS_MAPPED_IN ? length : 0;
+    counters->mapped_out += mapped & STATS_MAPPED_OUT ? length : 0;
+    return index;
+}
+
+/**
+* Printing a Rate
+* @brief Prints the GB/s of a phase for --stats, or n/a (null in JSON) if the phase took less than STATS_MIN_SECONDS.
+*
+* @param bytes bytes of the phase
+* @param seconds time of the phase
+* @param json nonzero for JSON
+*/
+static void print_rate(unsigned long long bytes, double seconds, int json){
+    if(seconds < STATS_MIN_SECONDS){
+        fprintf(stderr, json ? "null" : "%9s", "n/a");
+        return;
+    }
+    fprintf(stderr, json ? "%.3f" : "%9.3f", bytes / seconds / 1e9);
+}
+
+/**
+* Printing the Stats
+* @brief Merges the counters of all threads and prints them to stderr (atexit handler of --stats).
+* @details Phase times are summed over all threads, so with several threads they can exceed the wall time.
+*          Bytes in and out include the bytes read from and written to mappings. On the mapped paths the map phase
+*          holds mmap() and msync() and the (de)encryption over the mappings, see stats_cipher_mapped.
+*/
+static void print_stats(void){
+    static const char *phases[STATS_PHASES] = {"read", "map", "transform", "write"};
+    static const char *syscalls[STATS_SYSCALLS] = {"read", "write", "mmap", "msync", "io_uring_enter", "vmsplice"};
+    stats_counters total;
+    struct rusage resources;
+    double wall = stats_clock() - stats_start;
+
+    memset(&total, 0, sizeof(total));
+    pthread_mutex_lock(&stats_lock);
+    for(stats_counters *counters = stats_threads; counters != NULL; counters = counters->next){
+        for(int i = 0; i < STATS_PHASES; i++){
+            total.bytes[i] += counters->bytes[i];
+            total.seconds[i] += counters->seconds[i];
+        }
+        for(int i = 0; i < STATS_SYSCALLS; i++){
+            total.syscalls[i] += counters->syscalls[i];
+        }
+        total.mapped_in += counters->mapped_in;
+        total.mapped_out += counters->mapped_out;
+        total.lines += counters->lines;
+        total.letters += counters->letters;
+    }
+    pthread_mutex_unlock(&stats_lock);
+    if(getrusage(RUSAGE_SELF, &resources) == -1){
+        memset(&resources, 0, sizeof(resources));
+    }
+    double user = resources.ru_utime.tv_sec + resources.ru_utime.tv_usec / 1e6;
+    double sys = resources.ru_stime.tv_sec + resources.ru_stime.tv_usec / 1e6;
+    unsigned long long transformed = total.bytes[STATS_TRANSFORM];
+    unsigned long long bytes_in = total.bytes[STATS_READ] + total.mapped_in;
+    unsigned long long bytes_out = total.bytes[STATS_WRITE] + total.mapped_out;
+
+    if(stats_mode == STATS_JSON){
+        fprintf(stderr, "{\"bytes_in\":%llu,\"bytes_out\":%llu,\"lines\":%llu,\"letters\":%llu,\"passed\":%llu,"
+                "\"wall\":%.6f,\"user\":%.6f,\"sys\":%.6f", bytes_in, bytes_out,
+                total.lines, total.letters, transformed - total.letters, wall, user, sys);
+        for(int i = 0; i < STATS_PHASES; i++){
+            fprintf(stderr, ",\"%s\":{\"bytes\":%llu,\"seconds\":%.6f,\"gbps\":", phases[i], total.bytes[i],
+                    total.seconds[i]);
+            print_rate(total.bytes[i], total.seconds[i], 1);
+            fprintf(stderr, "}");
+        }
+        fprintf(stderr, ",\"syscalls\":{");
+        for(int i = 0; i < STATS_SYSCALLS; i++){
+            fprintf(stderr, "%s\"%s\":%llu", i == 0 ? "" : ",", syscalls[i], total.syscalls[i]);
+        }
+        fprintf(stderr, "}}\n");
+        return;
+    }
+
+    fprintf(stderr, "vigenere: %llu bytes in, %llu bytes out, %llu lines, %llu letters transformed, %llu bytes passed\n",
+            bytes_in, bytes_out, total.lines, total.letters, transformed - total.letters);
+    fprintf(stderr, "vigenere: wall %.3f s, user %.3f s, sys %.3f s\n", wall, user, sys);
+    for(int i = 0; i < STATS_PHASES; i++){
+        fprintf(stderr, "vigenere: %-9s %14llu bytes %10.3f s ", phases[i], total.bytes[i], total.seconds[i]);
+        print_rate(total.bytes[i], total.seconds[i], 0);
+        fprintf(stderr, " GB/s\n");
+    }
+    fprintf(stderr, "vigenere: syscalls");
+    for(int i = 0; i < STATS_SYSCALLS; i++){
+        fprintf(stderr, " %s %llu", syscalls[i], total.syscalls[i]);
+    }
+    fprintf(stderr, "\n");
+}
+
+/**
+* Starting the Stats
+* @brief Enables the --stats counters and prints them when the program exits.
+*
+* @param mode STATS_TEXT or STATS_JSON
+*/
+void start_stats(int mode){
+    stats_mode = mode;
+    stats_start = stats_clock();
+    if(atexit(print_stats) != 0){
+        usage("./vigenere: error occured while registering the stats.");
+    }
+}
@@ -0,0 +1,73 @@
+/**
+ * @file stats.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief --stats of vigenere.
+ *
+ * @details Every thread counts the bytes, time and syscalls of the read, map, transform and write phases into its own
+ *          counters, they are merged and printed when the program exits. stats_mode is STATS_OFF unless --stats was
+ *          given.
+ **/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <sys/types.h>
+
+#include "libvigenere_internal.h"
+
+// region: STATS (--stats)
+#define STATS_OFF (0)
+#define STATS_TEXT (1)
+#define STATS_JSON (2)
+#define STATS_READ (0) // phases
+#define STATS_MAP (1)
+#define STATS_TRANSFORM (2)
+#define STATS_WRITE (3)
+#define STATS_PHASES (4)
+#define STATS_SYSCALL_READ (0) // counted syscalls
+#define STATS_SYSCALL_WRITE (1)
+#define STATS_SYSCALL_MMAP (2)
+#define STATS_SYSCALL_MSYNC (3)
+#define STATS_SYSCALL_URING (4)
+#define STATS_SYSCALL_VMSPLICE (5)
+#define STATS_SYSCALLS (6)
+#define STATS_MAPPED_IN (1) // the input of stats_cipher_mapped is a mapping
+#define STATS_MAPPED_OUT (2) // the output of stats_cipher_mapped is a mapping
+
+/**
+ * @struct stats_counters
+ * @brief This structure represents the --stats counters of one thread.
+ * @details Every thread counts into its own structure without locking; the structures are linked into stats_threads
+ *          when a thread counts for the first time and merged when the program exits.
+ *          bytes, seconds and calls are indexed by phase (STATS_READ, STATS_MAP, STATS_TRANSFORM, STATS_WRITE), syscalls
+ *          by STATS_SYSCALL_*. lines and letters count the (de)encrypted input, letters are transformed, every other
+ *          byte is passed through (or replaced). mapped_in and mapped_out count the bytes read from and written to
+ *          mappings, which are not part of the read and write phases.
+ */
+typedef struct stats_counters{
+    unsigned long long bytes[STATS_PHASES];
+    double seconds[STATS_PHASES];
+    unsigned long long syscalls[STATS_SYSCALLS];
+    unsigned long long mapped_in;
+    unsigned long long mapped_out;
+    unsigned long long lines;
+    unsigned long long letters;
+    struct stats_counters *next;
+} stats_counters;
+
+extern int stats_mode;
+
+double stats_clock(void);
+stats_counters *stats_thread(void);
+void stats_count(int phase, int syscall, size_t bytes, double start);
+ssize_t stats_read(int fd, void *buffer, size_t length);
+ssize_t stats_pread(int fd, void *buffer, size_t length, off_t offset);
+ssize_t stats_write(int fd, const void *data, size_t length);
+void stats_text(const char *in, size_t length, size_t outputs);
+size_t stats_cipher(vigenere_table *table, const char *in, char *out, size_t length, size_t index);
+size_t stats_cipher_mapped(vigenere_table *table, const char *in, char *out, size_t length, size_t index, int mapped);
+void start_stats(int mode);
+
+#endif
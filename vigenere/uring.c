@@ -0,0 +1,368 @@
+/**
+ * @file uring.c
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief io_uring engine of vigenere (--io=uring).
+ **/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+#include "vigenere.h"
+#include "uring.h"
+#include "output.h"
+#include "stats.h"
+
+#ifdef __linux__
+#define URING_ENGINE
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#define URING_BLOCK_SIZE (1 << 20) // size of an io_uring transfer (1 MiB)
+#define URING_BLOCKS (8) // number of registered io_uring buffers
+
+// region: IO_URING_BLOCK_STATES
+#define BLOCK_FREE (0)
+#define BLOCK_READING (1)
+#define BLOCK_READ (2)
+#define BLOCK_CIPHERED (3)
+#define BLOCK_WRITING (4)
+
+#ifdef URING_ENGINE
+
+/**
+ * @struct uring
+ * @brief This structure represents an io_uring instance with its mapped submission and completion rings.
+ */
+typedef struct{
+    int fd;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;
+    void *cq_ring;
+    size_t sq_ring_size;
+    size_t cq_ring_size;
+    size_t sqes_size;
+    unsigned pending;
+} uring;
+
+/**
+ * @struct uring_block
+ * @brief This structure represents one registered buffer and the block of the file it currently holds.
+ * @details done counts the bytes already read or written, for resubmitting short transfers.
+ */
+typedef struct{
+    int state;
+    off_t block;
+    size_t length;
+    size_t done;
+} uring_block;
+
+/**
+* Setting up io_uring
+* @brief Creates an io_uring instance and maps its rings.
+*
+* @param ring ring to be set up
+* @param entries number of submission queue entries
+* @return 0 on success, -1 if io_uring is not available
+*/
+static int uring_setup(uring *ring, unsigned entries){
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    ring->fd = syscall(__NR_io_uring_setup, entries, &params);
+    if(ring->fd < 0){
+        return -1;
+    }
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if(params.features & IORING_FEAT_SINGLE_MMAP){
+        if(ring->cq_ring_size > ring->sq_ring_size){
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if(ring->sq_ring == MAP_FAILED){
+        close(ring->fd);
+        return -1;
+    }
+    ring->cq_ring = ring->sq_ring;
+    if(!(params.features & IORING_FEAT_SINGLE_MMAP)){
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if(ring->cq_ring == MAP_FAILED){
+            munmap(ring->sq_ring, ring->sq_ring_size);
+            close(ring->fd);
+            return -1;
+        }
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if(ring->sqes == MAP_FAILED){
+        if(ring->cq_ring != ring->sq_ring){
+            munmap(ring->cq_ring, ring->cq_ring_size);
+        }
+        munmap(ring->sq_ring, ring->sq_ring_size);
+        close(ring->fd);
+        return -1;
+    }
+
+    ring->sq_tail = (unsigned *) ((char *) ring->sq_ring + params.sq_off.tail);
+    ring->sq_mask = (unsigned *) ((char *) ring->sq_ring + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *) ((char *) ring->sq_ring + params.sq_off.array);
+    ring->cq_head = (unsigned *) ((char *) ring->cq_ring + params.cq_off.head);
+    ring->cq_tail = (unsigned *) ((char *) ring->cq_ring + params.cq_off.tail);
+    ring->cq_mask = (unsigned *) ((char *) ring->cq_ring + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *) ((char *) ring->cq_ring + params.cq_off.cqes);
+    ring->pending = 0;
+    return 0;
+}
+
+/**
+* Closing io_uring
+* @brief Unmaps the rings and closes the instance.
+*
+* @param ring io_uring instance
+*/
+static void uring_close(uring *ring){
+    munmap(ring->sqes, ring->sqes_size);
+    if(ring->cq_ring != ring->sq_ring){
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fd);
+}
+
+/**
+* Queueing a Transfer
+* @brief Adds a read or write to the submission queue.
+*
+* @param ring io_uring instance
+* @param opcode IORING_OP_READ(_FIXED) or IORING_OP_WRITE(_FIXED)
+* @param fd file descriptor
+* @param buffer memory of the transfer
+* @param length number of bytes
+* @param offset file offset, -1 for the current file position
+* @param buffer_index index of the registered buffer (fixed transfers)
+* @param user_data returned with the completion
+*/
+static void uring_queue(uring *ring, int opcode, int fd, char *buffer, size_t length, off_t offset, int buffer_index, unsigned long long user_data){
+    unsigned tail = *ring->sq_tail;
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = (unsigned long) buffer;
+    sqe->len = length;
+    sqe->off = (unsigned long long) offset;
+    sqe->buf_index = buffer_index;
+    sqe->user_data = user_data;
+
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->pending++;
+}
+
+/**
+* Submitting and Waiting
+* @brief Submits the queued transfers and waits for at least one completion.
+* @details With --stats the waiting is counted as read phase, the transferred bytes are counted with the completions.
+*
+* @param ring io_uring instance
+* @return 0 on success, -1 on error
+*/
+static int uring_submit_and_wait(uring *ring){
+    for(;;){
+        double start = stats_mode == STATS_OFF ? 0 : stats_clock();
+        int result = syscall(__NR_io_uring_enter, ring->fd, ring->pending, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if(stats_mode != STATS_OFF){
+            stats_count(STATS_READ, STATS_SYSCALL_URING, 0, start);
+        }
+        if(result >= 0){
+            ring->pending -= result;
+            return 0;
+        }
+        if(errno != EINTR){
+            return -1;
+        }
+    }
+}
+
+/**
+* Queueing a Block Transfer
+* @brief Queues the (remaining) read or write of a block.
+*
+* @param ring io_uring instance
+* @param blocks block states
+* @param buffers registered buffers
+* @param fixed 1 if the buffers are registered
+* @param id index of the buffer
+* @param write 1 for a write, 0 for a read
+* @param fd file descriptor
+* @param offset file offset of the block, -1 for the current file position
+*/
+static void uring_queue_block(uring *ring, uring_block *blocks, char *buffers, int fixed, int id, int write, int fd, off_t offset){
+    uring_block *block = &blocks[id];
+    int opcode = write ? (fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE) : (fixed ? IORING_OP_READ_FIXED : IORING_OP_READ);
+
+    uring_queue(ring, opcode, fd, buffers + (size_t) id * URING_BLOCK_SIZE + block->done, block->length - block->done,
+                offset == -1 ? -1 : offset + (off_t) block->done, id, ((unsigned long long) id << 1) | write);
+}
+
+/**
+* Ciphering with io_uring
+* @brief (De)encrypts a regular file with several reads and writes in flight.
+* @details URING_BLOCKS registered buffers cycle through read, (de)encryption (in file order) and write, so the latency
+*          of the input and output overlaps with the cipher. Writes to a seekable output use explicit offsets and may be
+*          in flight together; writes to pipes and O_APPEND files are issued one after another.
+*
+* @param table cipher table of the key
+* @param fd input file descriptor (regular file)
+* @param size size of the file
+* @param writer buffered output
+* @return 0 on success, -1 on a read error, 1 if io_uring is not available
+*/
+int cipher_uring(vigenere_table *table, int fd, off_t size, output_writer *writer){
+    uring ring;
+    if(uring_setup(&ring, 2 * URING_BLOCKS) == -1){
+        return 1;
+    }
+
+    char *buffers;
+    if(posix_memalign((void **) &buffers, OUTPUT_BUFFER_ALIGNMENT, (size_t) URING_BLOCKS * URING_BLOCK_SIZE) != 0){
+        usage("./vigenere: error occured while allocating the io_uring buffers.");
+    }
+    struct iovec vectors[URING_BLOCKS];
+    uring_block blocks[URING_BLOCKS];
+    for(int i = 0; i < URING_BLOCKS; i++){
+        vectors[i].iov_base = buffers + (size_t) i * URING_BLOCK_SIZE;
+        vectors[i].iov_len = URING_BLOCK_SIZE;
+        blocks[i].state = BLOCK_FREE;
+    }
+    int fixed = syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_BUFFERS, vectors, URING_BLOCKS) == 0;
+
+    flush_output(writer);
+    int output = output_fd(writer);
+    struct stat st;
+    off_t base = lseek(output, 0, SEEK_CUR);
+    int seekable = base != -1 && fstat(output, &st) == 0 && S_ISREG(st.st_mode) && !(fcntl(output, F_GETFL) & O_APPEND);
+
+    off_t count = (size + URING_BLOCK_SIZE - 1) / URING_BLOCK_SIZE;
+    off_t next_read = 0, next_cipher = 0, next_write = 0;
+    int writes = 0, error = 0;
+    size_t index = 0;
+
+    while(!error && (next_write < count || writes > 0)){
+        while(next_read < count && blocks[next_read % URING_BLOCKS].state == BLOCK_FREE){
+            int id = next_read % URING_BLOCKS;
+            blocks[id].state = BLOCK_READING;
+            blocks[id].block = next_read;
+            blocks[id].done = 0;
+            blocks[id].length = size - next_read * URING_BLOCK_SIZE < URING_BLOCK_SIZE ? (size_t) (size - next_read * URING_BLOCK_SIZE) : URING_BLOCK_SIZE;
+            uring_queue_block(&ring, blocks, buffers, fixed, id, 0, fd, next_read * URING_BLOCK_SIZE);
+            next_read++;
+        }
+
+        while(next_cipher < next_read && blocks[next_cipher % URING_BLOCKS].state == BLOCK_READ){
+            int id = next_cipher % URING_BLOCKS;
+            char *buffer = buffers + (size_t) id * URING_BLOCK_SIZE;
+            index = stats_cipher(table, buffer, buffer, blocks[id].length, index);
+            blocks[id].state = BLOCK_CIPHERED;
+            next_cipher++;
+        }
+
+        while(next_write < next_cipher && (seekable || writes == 0)){
+            int id = next_write % URING_BLOCKS;
+            blocks[id].state = BLOCK_WRITING;
+            blocks[id].done = 0;
+            uring_queue_block(&ring, blocks, buffers, fixed, id, 1, output, seekable ? base + next_write * URING_BLOCK_SIZE : -1);
+            writes++;
+            next_write++;
+        }
+
+        if(next_write == count && writes == 0){
+            break;
+        }
+
+        if(uring_submit_and_wait(&ring) == -1){
+            error = 1;
+            break;
+        }
+
+        unsigned head = *ring.cq_head;
+        unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        for(; head != tail; head++){
+            struct io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+            int id = cqe->user_data >> 1;
+            int write = cqe->user_data & 1;
+            uring_block *block = &blocks[id];
+
+            if(cqe->res == -EINTR || cqe->res == -EAGAIN){
+                cqe->res = 0;
+            }
+            else if(cqe->res <= 0){
+                if(write){
+                    usage("./vigenere: error occured while writing the output.");
+                }
+                error = 1;
+                continue;
+            }
+
+            block->done += cqe->res;
+            if(stats_mode != STATS_OFF){
+                stats_thread()->bytes[write ? STATS_WRITE : STATS_READ] += cqe->res;
+            }
+            if(block->done < block->length){
+                off_t offset = write ? (seekable ? base + block->block * URING_BLOCK_SIZE : -1) : block->block * URING_BLOCK_SIZE;
+                uring_queue_block(&ring, blocks, buffers, fixed, id, write, write ? output : fd, offset);
+            }
+            else if(write){
+                block->state = BLOCK_FREE;
+                writes--;
+            }
+            else{
+                block->state = BLOCK_READ;
+            }
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    if(seekable && !error){
+        lseek(output, base + size, SEEK_SET);
+    }
+    uring_close(&ring);
+    free(buffers);
+    return error ? -1 : 0;
+}
+
+#else
+
+/**
+* Ciphering with io_uring
+* @brief io_uring is not available on this platform.
+*
+* @return 1
+*/
+int cipher_uring(vigenere_table *table, int fd, off_t size, output_writer *writer){
+    return 1;
+}
+
+#endif
@@ -0,0 +1,22 @@
+/**
+ * @file uring.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief io_uring engine of vigenere (--io=uring).
+ *
+ * @details Reads and writes of a regular file go through io_uring with registered buffers, without liburing.
+ *          cipher_uring returns 1 where io_uring is not available.
+ **/
+
+#ifndef URING_H
+#define URING_H
+
+#include <sys/types.h>
+
+#include "libvigenere_internal.h"
+#include "output.h"
+
+int cipher_uring(vigenere_table *table, int fd, off_t size, output_writer *writer);
+
+#endif
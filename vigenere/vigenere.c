@@ -7,6 +7,8 @@
  * 
  * This program takes a speffic key and ciphers the given text to a file or stdout.
  * ./vigenere "arslan" input.txt (for Example)
+ * This file parses the arguments and picks the I/O engine, the engines, the line index, --keys, --crack, --daemon,
+ * -z and --stats live in their own modules.
  **/
 
 #include <stdio.h>
@@ -14,6 +16,35 @@
 #include <unistd.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/stat.h>
+
+#include "vigenere.h"
+#include "stats.h"
+#include "output.h"
+#include "pipeline.h"
+#include "parallel.h"
+#include "mapped.h"
+#include "uring.h"
+#include "line_index.h"
+#include "splice.h"
+#include "keys.h"
+#include "crack.h"
+#include "daemon.h"
+#include "compress.h"
+
+// region: LONG_OPTIONS
+#define OPTION_IO (256)
+#define OPTION_INDEX (257)
+#define OPTION_LINES (258)
+#define OPTION_BYTES (259)
+#define OPTION_KEYS (260)
+#define OPTION_CRACK (261)
+#define OPTION_DAEMON (262)
+#define OPTION_STATS (263)
 
 /**
 * Usage function.
@@ -28,36 +59,185 @@ void usage(char *error){
     exit(EXIT_FAILURE);
 }
 
+/**
+* Parsing a Range
+* @brief Parses a range of the form A-B, A- or A (1-based, inclusive).
+*
+* @param text range given on the command line
+* @param first set to A
+* @param last set to B (ULLONG_MAX for A-, A for A)
+* @return 0 on success, -1 if the range is invalid
+*/
+static int parse_range(char *text, unsigned long long *first, unsigned long long *last){
+    char *end;
+
+    if(!isdigit((unsigned char) text[0])){
+        return -1;
+    }
+    *first = strtoull(text, &end, 10);
+    if(*end == '\0'){
+        *last = *first;
+    }
+    else if(*end == '-' && end[1] == '\0'){
+        *last = ULLONG_MAX;
+    }
+    else if(*end == '-' && isdigit((unsigned char) end[1])){
+        *last = strtoull(end + 1, &end, 10);
+        if(*end != '\0'){
+            return -1;
+        }
+    }
+    else{
+        return -1;
+    }
+
+    return *first >= 1 && *last >= *first ? 0 : -1;
+}
+
 /**
 * Argument handler and assigner.
 * @brief Takes the arguments given via bash and handles and assigns the accordingly.
-* @details Handles the arguments on the following synopsis: vigenere [-d] [-o outfile] key [file...].
+* @details Handles the arguments on the following synopsis:
+*          vigenere [-d] [-j threads] [-o outfile | -i] [--io=auto|read|mmap|uring|splice|pipeline] [--index=FILE]
+*                   [--lines=A-B | --bytes=A-B] key [file...]
+*          vigenere [-d] -z [-o outfile] key [file...]
+*          vigenere [-d] -o outfile --keys=KEY1,KEY2,... [file...]
+*          vigenere [-j threads] --crack file
+*          vigenere [-j threads] --daemon=SOCKET.
+*          --stats[=text|json] can be added to every form, the counters are printed to stderr on exit.
 *          If the synopsis is not satisfied, it will exit with EXIT_FAILURE and the corresponding usage message.
-*          decrypt, outfile, key, input_files will be assigned.
+*          --index, --lines and --bytes need exactly one input file.
+*          --io=uring reads regular files with io_uring; other inputs, and all inputs if io_uring is not available,
+*          fall back to plain read() and write() as with --io=read.
+*          decrypt, outfile, key, input_files, threads, in_place, io, index_file, the range, keys, crack,
+*          daemon_socket, stats and compress will be assigned.
 *
 * @param argc number of arguments
 * @param argv array of all arguments
-* @param outfile output file
-* @param key key argument
-* @param input_files starting index of input files
+* @param args parsed arguments
 */
-void handle_arguments(int argc, char* argv[], int *decrypt, char **outfile, char **key, int *input_files){
+static void handle_arguments(int argc, char* argv[], arguments *args){
     int option;
-    int key_position = 1;
-
-    while ((option = getopt(argc, argv, "do:")) != -1) {
+    char *end;
+
+    args->decrypt = -1;
+    args->outfile = NULL;
+    args->key = NULL;
+    args->input_files = -1;
+    args->threads = 1;
+    args->in_place = 0;
+    args->io = IO_AUTO;
+    args->index_file = NULL;
+    args->range = RANGE_NONE;
+    args->keys = NULL;
+    args->crack = 0;
+    args->daemon_socket = NULL;
+    args->stats = STATS_OFF;
+    args->compress = 0;
+
+    struct option long_options[] = {
+        {"io", required_argument, NULL, OPTION_IO},
+        {"index", required_argument, NULL, OPTION_INDEX},
+        {"lines", required_argument, NULL, OPTION_LINES},
+        {"bytes", required_argument, NULL, OPTION_BYTES},
+        {"keys", required_argument, NULL, OPTION_KEYS},
+        {"crack", no_argument, NULL, OPTION_CRACK},
+        {"daemon", required_argument, NULL, OPTION_DAEMON},
+        {"stats", optional_argument, NULL, OPTION_STATS},
+        {NULL, 0, NULL, 0}
+    };
+
+    while ((option = getopt_long(argc, argv, "dij:o:z", long_options, NULL)) != -1) {
         switch (option) {
             case 'd':
-                if(*decrypt == -1){
-                    *decrypt = 1;
+                if(args->decrypt == -1){
+                    args->decrypt = 1;
                 }
                 else{
                     usage("./vigenere: option -d was declared more than once.");
                 }
                 break;
 
+            case 'i':
+                args->in_place = 1;
+                break;
+
+            case 'j':
+                args->threads = (int) strtol(optarg, &end, 10);
+                if(*end != '\0' || args->threads < 1 || args->threads > MAX_THREADS){
+                    usage("./vigenere: option -j needs a number of threads between 1 and 256.");
+                }
+                break;
+
             case 'o':
-                *outfile = optarg;
+                args->outfile = optarg;
+                break;
+
+            case 'z':
+                args->compress = 1;
+                break;
+
+            case OPTION_IO:
+                if(strcmp(optarg, "auto") == 0){
+                    args->io = IO_AUTO;
+                }
+                else if(strcmp(optarg, "read") == 0){
+                    args->io = IO_READ;
+                }
+                else if(strcmp(optarg, "mmap") == 0){
+                    args->io = IO_MMAP;
+                }
+                else if(strcmp(optarg, "uring") == 0){
+                    args->io = IO_URING;
+                }
+                else if(strcmp(optarg, "splice") == 0){
+                    args->io = IO_SPLICE;
+                }
+                else if(strcmp(optarg, "pipeline") == 0){
+                    args->io = IO_PIPELINE;
+                }
+                else{
+                    usage("./vigenere: option --io needs one of auto, read, mmap, uring, splice, pipeline.");
+                }
+                break;
+
+            case OPTION_INDEX:
+                args->index_file = optarg;
+                break;
+
+            case OPTION_LINES:
+            case OPTION_BYTES:
+                if(args->range != RANGE_NONE){
+                    usage("./vigenere: only one of --lines and --bytes can be given.");
+                }
+                if(parse_range(optarg, &args->range_first, &args->range_last) == -1){
+                    usage("./vigenere: a range needs the form A-B, A- or A with 1 <= A <= B.");
+                }
+                args->range = option == OPTION_LINES ? RANGE_LINES : RANGE_BYTES;
+                break;
+
+            case OPTION_KEYS:
+                args->keys = optarg;
+                break;
+
+            case OPTION_CRACK:
+                args->crack = 1;
+                break;
+
+            case OPTION_DAEMON:
+                args->daemon_socket = optarg;
+                break;
+
+            case OPTION_STATS:
+                if(optarg == NULL || strcmp(optarg, "text") == 0){
+                    args->stats = STATS_TEXT;
+                }
+                else if(strcmp(optarg, "json") == 0){
+                    args->stats = STATS_JSON;
+                }
+                else{
+                    usage("./vigenere: option --stats takes text or json.");
+                }
                 break;
 
             case '?':
@@ -68,288 +248,212 @@ void handle_arguments(int argc, char* argv[], int *decrypt, char **outfile, char
         }
     }
 
-
-    if(*decrypt != -1){
-        key_position++;
+    if(args->daemon_socket != NULL){
+        if(optind != argc || args->decrypt == 1 || args->outfile != NULL || args->in_place || args->keys != NULL
+           || args->crack || args->compress || args->index_file != NULL || args->range != RANGE_NONE){
+            usage("./vigenere: option --daemon takes no key, files or other options than -j.");
+        }
+        return;
     }
-    if(*outfile != NULL){
-        key_position = key_position + 2;
+
+    if(args->crack){
+        if(optind != argc - 1 || args->outfile != NULL || args->in_place || args->keys != NULL || args->index_file != NULL
+           || args->range != RANGE_NONE || args->compress){
+            usage("./vigenere: option --crack needs exactly one input file and no key, -o, -i, -z, --keys, --index or range.");
+        }
+        args->input_files = optind;
+        return;
     }
 
-    int input_start = key_position;
+    if(args->keys != NULL){
+        if(args->outfile == NULL || args->in_place || args->index_file != NULL || args->range != RANGE_NONE || args->compress){
+            usage("./vigenere: option --keys needs -o and cannot be used with -i, -z, --index, --lines or --bytes.");
+        }
+        if(optind < argc){
+            args->input_files = optind;
+        }
+        return;
+    }
 
-    if(key_position < argc){
-        *key = argv[key_position];
-        input_start++;
+    if(optind < argc){
+        args->key = argv[optind];
     }
     else
     {
         usage("./vigenere: the key was not specified.");
     }
 
-    if(input_start < argc){
-        *input_files = input_start;
+    if(optind + 1 < argc){
+        args->input_files = optind + 1;
     }
-}
 
-/**
-* Converting a letter to [0-25] Range
-* @brief Covnerts a character to a range [0-25].
-* @details The function will turn all uppercase and lowercase alphabetical characters to a range of [0-25] and 
-*          give the corresponding value back.
-*
-* @param ch parsed character
-* @return the corresponding integer of the range [0-25], otherwise -1.
-*/
-int convert_char(char ch){
-    if(ch >= 65 && ch <= 90){
-        return (int)(ch) - 65;
-    }
-    if(ch >=97 && ch <= 122){
-        return (int)(ch) - 97;
+    if(args->in_place && (args->outfile != NULL || args->input_files == -1)){
+        usage("./vigenere: option -i needs input files and cannot be used with -o.");
     }
-    return -1;
-}
 
-/**
-* Lower or uppercase
-* @brief Returns the lowbound of the range needed.
-* @details This function will check for lower or uppercase and return accordingly 65 or 97 (starting ASCII values used
-*          for calculation). 
-*
-* @param ch parsed character
-* @return 65 for uppercase, 97 lowercase, otherwise -1.
-*/
-int lower_upper(char ch){
-    if(ch >= 65 && ch <= 90){
-        return 65;
-    }
-    if(ch >=97 && ch <= 122){
-        return 97;
+    if((args->index_file != NULL || args->range != RANGE_NONE) && (args->input_files != argc - 1 || args->in_place)){
+        usage("./vigenere: options --index, --lines and --bytes need exactly one input file and cannot be used with -i.");
     }
-    return -1;
-}
 
-/**
-* Special Character Check
-* @brief Checks whether the parsed character is special.
-* @details This function checks for .,:-!=?% and whitespaces, as well as for numbers and \n characters. 
-*
-* @param ch parsed character
-* @return 1 on ch=special, -1 otherwise.
-*/
-int special_character(char ch){
-
-    if(ch >= 48 && ch <= 57){
-        return 1;
-    }
-
-    if(ch == '.'){
-        return 1;
-    }
-    if(ch == ','){
-        return 1;
-    }
-    if(ch == ':'){
-        return 1;
-    }
-    if(ch == '-'){
-        return 1;
-    }
-    if(ch == '!'){
-        return 1;
+    if(args->compress && (args->in_place || args->index_file != NULL || args->range != RANGE_NONE)){
+        usage("./vigenere: option -z cannot be used with -i, --index, --lines or --bytes.");
     }
-    if(ch == '='){
-        return 1;
-    }
-    if(ch == '?'){
-        return 1;
-    }
-    if(ch == '%'){
-        return 1;
-    }
-    if(ch == ' '){
-        return 1;
-    }
-    if(ch == '\n'){
-        return 1;
-    }
-    
-    return 0;
 }
 
 /**
-* (De)Encryption Function
-* @brief Takes a key and (de)encrypts the letter accordingly.
-* @details This function encrpyts one character on the following form: E[i] = (L[i] + K[i mod lK] mod 26.
-*          If the decrpyt flag is on (decrypt = 1), then it decrypts on the form: D[i] = (L[i] − K[i mod lK] + 26) mod 26.
-*          E[i] is the encrypted character. L[i] is the parsed character(letter). i is the index_counter (current index of)
-*          K is the key.
+* Ciphering a Stream
+* @brief Reads a file descriptor block by block until EOF and ciphers it to the output.
 *
-* @param decrypt decrypt flag
-* @param key (de)encryption key
-* @param letter character to be encrypted
-* @param index_counter index of the letter
-* @param key_length length of the key
-* @return (de)encrypted character
+* @param table cipher table of the key
+* @param fd input file descriptor
+* @param writer buffered output
+* @return 0 on success, -1 on a read error
 */
-char de_encryption(int *decrypt, char *key, char letter, int index_counter, int key_length){
-    if(*decrypt != 1){
-        return (char) (((convert_char(letter) + convert_char(key[index_counter % key_length])) % 26) + lower_upper(letter));
-    }
-    else{
-        return (char) (((convert_char(letter) - convert_char(key[index_counter % key_length]) + 26) % 26) + lower_upper(letter));
+static int cipher_stream(vigenere_table *table, int fd, output_writer *writer){
+    char *buffer = malloc(INPUT_BUFFER_SIZE);
+    if(buffer == NULL){
+        usage("./vigenere: error occured while allocating the input buffer.");
     }
-}
 
-/**
-* Printing Output
-* @brief Takes a character and prints it to an output.
-* @details This function takes one character and prints it to stdout or specified output file. Note that, this is
-*          for writing one character at a time. If writing to a file, first opening should be set to 0.
-*
-* @param ch character to be written
-* @param output output file
-* @param first_opening 0 if writing to an output file
-* @param input input file (in case output crashes)
-*/
-void print_output(char ch, char *output, int *first_opening, FILE *input){
-    
-    if(output != NULL){
-        FILE *output_file;
-        if(*first_opening == 0){
-            output_file = fopen(output, "w");
-
-            if(output_file == NULL){
-                if(input != NULL){
-                    fclose(input);
-                }
-                usage("./viginere: Erorr occured while opening the output file.");
+    size_t index = 0;
+    ssize_t length;
+    while((length = stats_read(fd, buffer, INPUT_BUFFER_SIZE)) != 0){
+        if(length == -1){
+            if(errno == EINTR){
+                continue;
             }
-            *first_opening = 1;
+            free(buffer);
+            return -1;
         }
-        else{
-            output_file = fopen(output, "a");
-        }
-        fprintf(output_file, "%c", ch);
-        fclose(output_file);
-    }
-    else
-    {
-        fprintf(stdout, "%c", ch);
+        index = cipher_to_output(table, buffer, length, index, writer, 0);
     }
+
+    free(buffer);
+    return 0;
 }
 
 /**
 * Ciphering text from a file
-* @brief Ciphers the data from the file with the parsed key to the specified output.
-* @details This function opens a speffic input file and reads character for character. Every character is
-*          (de)encrypted along the way and printed to the output or stdout.
-
-* @param key (de)encryption key
-* @param key_length length of the key
-* @param decrypt decrypt flag (1 for present)
+* @brief Ciphers the data from the file with the precomputed tables to the specified output.
+* @details This function opens a speffic input file and reads it block by block. Every block is
+*          (de)encrypted along the way and written to the output or stdout.
+*          Regular files larger than one region are split between threads if more than one thread is given,
+*          other regular files are read with io_uring (--io=uring) or through a memory mapping (unless --io=read or
+*          --io=pipeline). Everything else goes through the reader/cipher/writer pipeline, or a plain read() loop with
+*          --io=read and --io=uring (also when io_uring is not available).
+
+* @param table cipher table of the key
 * @param file input file
-* @param outfile output file
-* @param first_opening 0 for deleting previous data from output file, 1 for adding
+* @param args parsed arguments (threads, io)
+* @param writer buffered output
 */
-void cipher_text_from_file(char *key, int key_length, int *decrypt, char *file, char *outfile, int *first_opening){
-    FILE* input;
-    char ch;
-    input = fopen(file, "r");
+static void cipher_text_from_file(vigenere_table *table, char *file, arguments *args, output_writer *writer){
+    int input = open(file, O_RDONLY);
 
-    if(input == NULL){
+    if(input == -1){
+        flush_output(writer);
         usage("./viginere: Erorr occured while opening the input file.");
     }
 
-    char encrypt_char;
-    int index_counter = 0;
-
-    while ((ch = fgetc(input)) != EOF) {
-        if(special_character(ch) == 1){
-            encrypt_char = ch;
-            if(encrypt_char == '\n')
-            {
-                index_counter = 0;
-            }
-            else
-            {
-                index_counter++;
-            }
+    struct stat st;
+    int result;
+    result = 1;
+    if(fstat(input, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0){
+        if(args->threads > 1 && st.st_size > REGION_SIZE){
+            result = cipher_parallel(table, input, st.st_size, args->threads, writer);
         }
-        else{
-            
-            encrypt_char = de_encryption(decrypt, key, ch, index_counter, key_length);
-            index_counter++;
+        else if(args->io == IO_URING){
+            result = cipher_uring(table, input, st.st_size, writer);
         }
-        
-        //printf("Encrypted: %c\n", encrypt_char);
-        print_output(encrypt_char, outfile, first_opening, input);
+        else if(args->io != IO_READ && args->io != IO_PIPELINE){
+            result = cipher_mapped(table, input, st.st_size, writer);
+        }
+    }
+    if(result == 1 && args->io != IO_READ && args->io != IO_URING){
+        result = cipher_pipeline(table, input, writer);
+    }
+    if(result == 1){
+        result = cipher_stream(table, input, writer);
+    }
+
+    if(result == -1){
+        flush_output(writer);
+        usage("./vigenere: error occured while reading the input file.");
     }
 
-    // fprintf(stdout, "\n");
-    fclose(input);
+    close(input);
 }
 
 /**
 * Ciphering text from stdin
-* @brief Ciphers the data from stdin with the parsed key to the specified output.
-* @details This function reads character for character from stdin. Every character is
-*          (de)encrypted along the way and printed to the output or stdout.
-
-* @param key (de)encryption key
-* @param key_length length of the key
-* @param decrypt decrypt flag (1 for present)
-* @param file input file
-* @param outfile output file
-* @param first_opening 0 for deleting previous data from output file, 1 for adding
+* @brief Ciphers the data from stdin with the precomputed tables to the specified output.
+* @details This function reads stdin block by block. Every block is
+*          (de)encrypted along the way and written to the output or stdout.
+*          With --io=splice and stdout a pipe, the output is handed to it with vmsplice, otherwise stdin goes
+*          through the reader/cipher/writer pipeline (unless --io=read or --io=uring, which use a plain read() loop).
+
+* @param table cipher table of the key
+* @param args parsed arguments (io)
+* @param writer buffered output
 */
-void cipher_text_from_stdin(char *key, int key_length, int *decrypt, char *outfile, int *first_opening){
-    int ch;
-    char encrypt_char;
-    int index_counter = 0;
-
-    while ((ch = getchar()) != EOF) {
-        if(special_character(ch) == 1){
-            // fprintf(stdout, "%c\n", ch);
-            encrypt_char = ch;
-            if(encrypt_char == '\n')
-            {
-                index_counter = 0;
-            }
-            else
-            {
-                index_counter++;
-            }
-        }
-        else{
-            encrypt_char = de_encryption(decrypt, key, ch, index_counter, key_length);
-            index_counter++;
-        }
-        
-        //printf("Encrypted: %c\n", encrypt_char);
-        print_output(encrypt_char, outfile, first_opening, NULL);
+static void cipher_text_from_stdin(vigenere_table *table, arguments *args, output_writer *writer){
+    int result = 1;
+    if(args->io == IO_SPLICE){
+        result = cipher_splice(table, writer);
+    }
+    if(result == 1 && args->io != IO_READ && args->io != IO_URING){
+        result = cipher_pipeline(table, STDIN_FILENO, writer);
+    }
+    if(result == 1){
+        result = cipher_stream(table, STDIN_FILENO, writer);
+    }
+    if(result == -1){
+        flush_output(writer);
+        usage("./vigenere: error occured while reading stdin.");
     }
 }
 
 /**
 * Uppercasing
 * @brief Takes a string and uppercases it.
-* @details This function takes a string and uppercases it. If there non-alphabetical characters, usage is called
+* @details This function takes a string and uppercases it. If there non-alphabetical characters or the key is empty, usage is called
 *          and the program exits with EXIT_FAILURE. Note: the key is case-insensitive.
 *
 * @param key (de)encryption key
 * @param key_length length of the key
 */
 void change_key(char *key, size_t key_length){
+    if(key_length == 0){
+        usage("./vigenere: parsed key is invalid.");
+    }
     for(int i=0; i<key_length; i++){
-        if(convert_char(key[i]) == -1){
+        if(vigenere_convert_char(key[i]) == -1){
             usage("./vigenere: parsed key is invalid.");
         }
         key[i] = toupper(key[i]);
     }
 }
 
+/**
+* Preparing the Cipher Table
+* @brief Builds the cipher table of an uppercased key, exiting with EXIT_FAILURE on errors.
+* @details The kernel is the one named by the VIGENERE_KERNEL environment variable, if set.
+*
+* @param table table to be built
+* @param key uppercased (de)encryption key
+* @param key_length length of the key
+* @param decrypt decrypt flag (1 for present)
+*/
+void prepare_table(vigenere_table *table, char *key, size_t key_length, int *decrypt){
+    int result = vigenere_build_table(table, key, key_length, decrypt, getenv(KERNEL_ENV));
+    if(result == VIGENERE_ERROR_MEMORY){
+        usage("./vigenere: error occured while allocating the cipher table.");
+    }
+    if(result == VIGENERE_ERROR_KERNEL){
+        usage("./vigenere: the requested kernel is not supported.");
+    }
+}
+
 /**
  * @brief Starting point of the program.
  * @details Entry point of the program. 
@@ -358,30 +462,94 @@ void change_key(char *key, size_t key_length){
  */
 int main(int argc, char* argv[])
 {
-    int decrypt = -1;
-    char *outfile = NULL;
-    char *key = NULL;
-    int input_files = -1;
+    arguments args;
 
+    handle_arguments(argc, argv, &args);
 
-    handle_arguments(argc, argv, &decrypt, &outfile, &key, &input_files);
+    if(args.stats != STATS_OFF){
+        start_stats(args.stats);
+    }
 
-    size_t key_length = strlen(key);
+    if(args.daemon_socket != NULL){
+        run_daemon(args.daemon_socket, args.threads);
+        return 0;
+    }
 
-    change_key(key, key_length);
+    if(args.crack){
+        crack_key(argv[args.input_files], args.threads);
+        return 0;
+    }
 
-    
+    if(args.keys != NULL){
+        cipher_keys(&args, argc, argv);
+        return 0;
+    }
 
-    int first_opening = 0;
+    size_t key_length = strlen(args.key);
 
-    if(input_files != -1){
-        for(int i = input_files; i < argc; i++){
-            cipher_text_from_file(key, key_length, &decrypt, argv[i], outfile, &first_opening);
+    change_key(args.key, key_length);
+
+    vigenere_table table;
+    prepare_table(&table, args.key, key_length, &args.decrypt);
+
+    if(args.index_file != NULL && args.range == RANGE_NONE){
+        index_input(argv[args.input_files], args.index_file);
+    }
+
+    if(args.range != RANGE_NONE){
+        output_writer writer;
+        open_output(&writer, args.outfile);
+        cipher_range(&table, argv[args.input_files], &args, &writer);
+        close_output(&writer);
+        vigenere_free_table(&table);
+        return 0;
+    }
+
+    if(args.compress){
+        output_writer writer;
+        open_output(&writer, args.outfile);
+        if(args.input_files == -1){
+            cipher_text_compressed(&table, NULL, args.decrypt == 1, &writer);
+        }
+        for(int i = args.input_files; i != -1 && i < argc; i++){
+            cipher_text_compressed(&table, argv[i], args.decrypt == 1, &writer);
+        }
+        close_output(&writer);
+        vigenere_free_table(&table);
+        return 0;
+    }
+
+    if(args.in_place){
+        for(int i = args.input_files; i < argc; i++){
+            cipher_in_place(&table, argv[i]);
+        }
+        vigenere_free_table(&table);
+        return 0;
+    }
+
+    if(args.outfile != NULL && args.input_files != -1 && args.threads == 1 && (args.io == IO_AUTO || args.io == IO_MMAP)
+       && cipher_files_mapped(&table, argv + args.input_files, argc - args.input_files, args.outfile)){
+        vigenere_free_table(&table);
+        return 0;
+    }
+
+    output_writer writer;
+    open_output(&writer, args.outfile);
+
+    if(args.input_files != -1 && args.threads > 1 && argc - args.input_files > 1){
+        cipher_files_parallel(&table, argv + args.input_files, argc - args.input_files, args.threads, &writer);
+    }
+    else if(args.input_files != -1){
+        for(int i = args.input_files; i < argc; i++){
+            cipher_text_from_file(&table, argv[i], &args, &writer);
         }
     }
     else{
-        cipher_text_from_stdin(key, key_length, &decrypt, outfile, &first_opening);
+        cipher_text_from_stdin(&table, &args, &writer);
     }
 
+    close_output(&writer);
+    vigenere_free_table(&table);
+
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,71 @@
+/**
+ * @file vigenere.h
+ * @author Arslan Smajevic <e12127678@student.tuwien.ac.at>
+ * @date 18.10.2026
+ *
+ * @brief Shared parts of the vigenere program.
+ *
+ * @details The parsed arguments, the I/O engines they select and the helpers every module of the program uses.
+ **/
+
+#ifndef VIGENERE_H
+#define VIGENERE_H
+
+#include "libvigenere_internal.h"
+
+#define INPUT_BUFFER_SIZE (1 << 20) // size of the input buffer (1 MiB)
+#define REGION_SIZE (4 << 20) // bytes of a file handled by one thread at a time (4 MiB)
+#define MAX_THREADS (256) // maximal number of threads (-j)
+#define KERNEL_ENV "VIGENERE_KERNEL" // forces a block kernel of libvigenere: generic, scalar, sse2, avx2 or avx512
+
+// region: IO_ENGINES (--io)
+#define IO_AUTO (0) // mmap for regular files, read() otherwise
+#define IO_READ (1) // read() and write() only
+#define IO_MMAP (2) // same as IO_AUTO
+#define IO_URING (3) // io_uring for regular files, plain read() and write() (IO_READ) for everything else or without io_uring
+#define IO_SPLICE (4) // vmsplice from stdin into a stdout pipe (only on request), same as IO_AUTO otherwise
+#define IO_PIPELINE (5) // reader/cipher/writer threads for every input, including regular files
+
+// region: RANGES
+#define RANGE_NONE (0)
+#define RANGE_LINES (1)
+#define RANGE_BYTES (2)
+
+/**
+ * @struct arguments
+ * @brief This structure represents the parsed arguments.
+ * @details decrypt is 1 if -d was given, -1 otherwise. input_files is the index of the first input file in argv,
+ *          -1 if stdin is used. threads is the number of threads given with -j (1 by default).
+ *          in_place is 1 if -i was given. io is the I/O engine given with --io (IO_AUTO by default).
+ *          index_file is the line index given with --index, NULL otherwise. range is RANGE_LINES or RANGE_BYTES if
+ *          --lines or --bytes was given, range_first and range_last are its bounds (1-based, inclusive).
+ *          keys is the comma-separated key list given with --keys, NULL otherwise (then key is set).
+ *          crack is 1 if --crack was given (then neither key nor keys is set).
+ *          daemon_socket is the socket path given with --daemon, NULL otherwise.
+ *          stats is STATS_TEXT or STATS_JSON if --stats was given, STATS_OFF otherwise.
+ *          compress is 1 if -z was given.
+ */
+typedef struct{
+    int decrypt;
+    char *outfile;
+    char *key;
+    int input_files;
+    int threads;
+    int in_place;
+    int io;
+    char *index_file;
+    int range;
+    unsigned long long range_first;
+    unsigned long long range_last;
+    char *keys;
+    int crack;
+    char *daemon_socket;
+    int stats;
+    int compress;
+} arguments;
+
+void usage(char *error);
+void change_key(char *key, size_t key_length);
+void prepare_table(vigenere_table *table, char *key, size_t key_length, int *decrypt);
+
+#endif